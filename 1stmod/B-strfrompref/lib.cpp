@@ -1,10 +1,21 @@
 #include "lib.hpp"
 
+#include <algorithm>
+
 using std::vector;
 using std::string;
 using std::max;
 using std::min;
 
+struct SquareFamily { // squares str[i, i + 2 * period) for all i in [first, last]
+  unsigned first;
+  unsigned last;
+  unsigned period;
+};
+
+void MainLorentz(const string& str, unsigned shift, vector<SquareFamily>& squares);
+unsigned GetZet(const vector<unsigned>& zet, int pos, unsigned limit);
+
 char FirstGoodLetter(const string& result, int start_pos);
 
 vector<unsigned> ZetFunc(const string& str) {
@@ -13,7 +24,9 @@ vector<unsigned> ZetFunc(const string& str) {
   unsigned left = 0;
   unsigned right = 0;
   for (int i = 1; i < sz; ++i) {
-    zet[i] = max(0U, min(right - i, zet[i - left]));
+    if (i < static_cast<int>(right)) { // inside the rightmost match
+      zet[i] = min(right - i, zet[i - left]);
+    }
     while (i + static_cast<int>(zet[i]) < sz && str[zet[i]] == str[i + zet[i]]) {
       ++zet[i]; // naive
     }
@@ -71,3 +84,152 @@ string PrefToString(const vector<unsigned>& pi) {
   }
   return result;
 }
+
+vector<unsigned> Periods(const string& str) {
+  int sz = str.size();
+  vector<unsigned> zet = ZetFunc(str);
+  vector<unsigned> periods;
+  for (int i = 1; i < sz; ++i) {
+    if (i + zet[i] == static_cast<unsigned>(sz)) { // the suffix is equal to the prefix
+      periods.push_back(i);
+    }
+  }
+  if (sz) {
+    periods.push_back(sz);
+  }
+  return periods;
+}
+
+string PrimitiveRoot(const string& str) {
+  for (unsigned period : Periods(str)) {
+    if (str.size() % period == 0) {
+      return str.substr(0, period);
+    }
+  }
+  return str;
+}
+
+unsigned GetZet(const vector<unsigned>& zet, int pos, unsigned limit) {
+  return (pos >= 0 && pos < static_cast<int>(zet.size())) ? min(zet[pos], limit) : 0;
+}
+
+void MainLorentz(const string& str, unsigned shift, vector<SquareFamily>& squares) {
+  int sz = str.size();
+  if (sz < 2) {
+    return;
+  }
+  int left_sz = sz / 2;
+  int right_sz = sz - left_sz;
+  string left = str.substr(0, left_sz);
+  string right = str.substr(left_sz);
+  MainLorentz(left, shift, squares);
+  MainLorentz(right, shift + left_sz, squares);
+  string rev_left(left.rbegin(), left.rend());
+  string rev_right(right.rbegin(), right.rend());
+  vector<unsigned> zet_rev_left = ZetFunc(rev_left); // common suffixes inside the left half
+  vector<unsigned> zet_right_left = ZetFunc(right + left); // prefixes of the right half in the left one
+  vector<unsigned> zet_rev_both = ZetFunc(rev_left + rev_right); // suffixes of the left half in the right one
+  vector<unsigned> zet_right = ZetFunc(right); // common prefixes inside the right half
+  for (int cntr = 0; cntr < sz; ++cntr) { // squares that cross the middle, grouped by the center
+    int len;
+    int suf;
+    int pref;
+    if (cntr < left_sz) {
+      len = left_sz - cntr;
+      suf = GetZet(zet_rev_left, left_sz - cntr, left_sz);
+      pref = GetZet(zet_right_left, right_sz + cntr, right_sz);
+    } else {
+      len = cntr - left_sz + 1;
+      suf = GetZet(zet_rev_both, left_sz + right_sz - 1 - (cntr - left_sz), left_sz);
+      pref = GetZet(zet_right, cntr - left_sz + 1, right_sz);
+    }
+    int lo = max(1, len - pref);
+    int hi = (cntr < left_sz) ? min(len - 1, suf) : min(len, suf);
+    if (lo > hi) {
+      continue;
+    }
+    if (cntr < left_sz) {
+      squares.push_back(SquareFamily{shift + cntr - hi, shift + cntr - lo, static_cast<unsigned>(len)});
+    } else {
+      squares.push_back(SquareFamily{shift + cntr - len - hi + 1, shift + cntr - len - lo + 1, static_cast<unsigned>(len)});
+    }
+  }
+}
+
+vector<Run> Runs(const string& str) {
+  vector<SquareFamily> squares;
+  MainLorentz(str, 0, squares);
+  sort(squares.begin(), squares.end(), [](const SquareFamily& lhs, const SquareFamily& rhs) {
+    return lhs.period < rhs.period || (lhs.period == rhs.period && lhs.first < rhs.first);
+  });
+  vector<Run> runs;
+  for (int i = 0; i < static_cast<int>(squares.size()); ) { // adjacent squares of one period form a maximal repetition
+    unsigned last = squares[i].last;
+    int j = i + 1;
+    while (j < static_cast<int>(squares.size()) && squares[j].period == squares[i].period && squares[j].first <= last + 1) {
+      last = max(last, squares[j].last);
+      ++j;
+    }
+    runs.push_back(Run{squares[i].first, last + 2 * squares[i].period, squares[i].period});
+    i = j;
+  }
+  sort(runs.begin(), runs.end(), [](const Run& lhs, const Run& rhs) {
+    return lhs.begin < rhs.begin || (lhs.begin == rhs.begin && (lhs.end < rhs.end ||
+           (lhs.end == rhs.end && lhs.period < rhs.period)));
+  });
+  vector<Run> result; // a repetition with a multiple period is the same run, keep the smallest period
+  for (const Run& run : runs) {
+    if (result.empty() || result.back().begin != run.begin || result.back().end != run.end) {
+      result.push_back(run);
+    }
+  }
+  return result;
+}
+
+unsigned long long TandemRepeatsNumber(const vector<Run>& runs) {
+  unsigned long long result = 0;
+  for (const Run& run : runs) {
+    unsigned sz = run.end - run.begin;
+    for (unsigned len = run.period; 2 * len <= sz; len += run.period) {
+      result += sz - 2 * len + 1;
+    }
+  }
+  return result;
+}
+
+RunsStream::RunsStream(unsigned window) :
+    window(window),
+    base(0),
+    prev_top(0) {
+
+}
+
+vector<Run> RunsStream::Feed(const string& chunk) {
+  buffer += chunk;
+  if (buffer.size() < 2 * window) {
+    return vector<Run>();
+  }
+  return Process(false);
+}
+
+vector<Run> RunsStream::Finish() {
+  return Process(true);
+}
+
+vector<Run> RunsStream::Process(bool last) {
+  unsigned top = base + buffer.size();
+  vector<Run> result;
+  for (Run run : Runs(buffer)) {
+    run.begin += base;
+    run.end += base;
+    if ((run.begin > base || base == 0) && (run.end < top || last) && run.end >= prev_top) {
+      result.push_back(run); // the run can't be extended anymore and wasn't reported before
+    }
+  }
+  prev_top = top;
+  if (buffer.size() > window) { // keep only the last window
+    base += buffer.size() - window;
+    buffer.erase(0, buffer.size() - window);
+  }
+  return result;
+}
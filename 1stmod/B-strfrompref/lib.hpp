@@ -8,4 +8,29 @@ std::string PrefToString(const std::vector<unsigned>& pi);
 std::vector<unsigned> ZetFunc(const std::string& str);
 std::vector<unsigned> ZetToPref(const std::vector<unsigned>& zet);
 
+struct Run { // maximal repetition str[begin, end) with the smallest period
+  unsigned begin;
+  unsigned end;
+  unsigned period;
+};
+
+std::vector<unsigned> Periods(const std::string& str); // all periods in increasing order
+std::string PrimitiveRoot(const std::string& str);
+std::vector<Run> Runs(const std::string& str); // Main-Lorentz, O(n log n) ZetFunc calls in total
+unsigned long long TandemRepeatsNumber(const std::vector<Run>& runs); // every square lies in exactly one run
+
+class RunsStream { // runs of a long input given by chunks, runs shorter than the window are reported exactly once
+  public:
+    RunsStream(unsigned window);
+    std::vector<Run> Feed(const std::string& chunk); // runs that can't change anymore
+    std::vector<Run> Finish();
+  private:
+    std::vector<Run> Process(bool last);
+
+    std::string buffer;
+    unsigned window;
+    unsigned base; // position of the buffer in the input
+    unsigned prev_top; // end of the previous processed buffer
+};
+
 #endif // MAIN_HPP_INCLUDED
@@ -1,26 +1,59 @@
 #include <iostream>
 #include <vector>
+#include <deque>
+#include <algorithm>
+#include <cstdint>
+#include <span>
+#include <thread>
 
 using std::swap;
 using std::max;
+using std::min;
+using std::pair;
 using std::string;
 using std::vector;
 
 static const int ALPH_LEN = 26;
 
+class RangeMin { // minimum on a segment of an array it doesn't own
+  public:
+    RangeMin() = default;
+    RangeMin(std::span<const int> values, bool compact = false); // compact takes O(n) memory, but queries inside a block take O(log n)
+    int Query(int left, int right) const; // minimum on [left, right]
+  private:
+    int TableQuery(int left, int right) const; // minimum over blocks [left, right]
+
+    std::span<const int> values;
+    int block = 1;
+    vector<int> prefix; // minimum from the block start, only in the compact mode
+    vector<int> suffix; // minimum up to the block end, only in the compact mode
+    vector<vector<int>> table; // sparse table over block minimums, table[k][i] covers blocks [i, i + 2^k)
+};
+
 class SuffixArray {
   public:
-    SuffixArray(const string& raw_text);
+    template <typename Container>
+    SuffixArray(const Container& raw_text); // any sequence of comparable symbols: string, vector<uint32_t>, ...
+    SuffixArray(const SuffixArray& other) = delete; // lcp_min points into lcp
+    SuffixArray(SuffixArray&& other) = default;
+    SuffixArray& operator=(const SuffixArray& other) = delete;
+    SuffixArray& operator=(SuffixArray&& other) = default;
     void BuildLCP(); // build lcp using the stored suffix array
+    void BuildRMQ(bool compact = false); // enables Lcp, has to be called after BuildLCP
     vector<int> GetArr() const;
     vector<int> GetLCP() const;
+    std::span<const int> ArrView() const; // same as GetArr without a copy
+    std::span<const int> LCPView() const; // same as GetLCP without a copy
+    int Lcp(int i, int j) const; // lcp of the suffixes starting at text positions i and j
   private:
+    template <typename Container>
+    void ReduceRanks(const Container& raw_text); // replaces symbols by their ranks, so buckets never exceed txt_sz
     void FirstSort();
     void NextSort(int step);
     inline int Jump(int i, int len); // jump backwards
 
-    string text;
     int txt_sz;
+    vector<int> text; // ranks of the symbols, '$' is 0
     vector<int> arr;
     vector<int> inverse;
     vector<int> new_arr;
@@ -28,9 +61,108 @@ class SuffixArray {
     vector<int> cls;
     vector<int> new_cls;
     vector<int> sort_counter;
+    RangeMin lcp_min;
+};
+
+class MismatchSearcher { // finds all occurrences of a query with at most k mismatches
+  public:
+    MismatchSearcher(const string& query, int mismatches, int threads = 0); // 0 threads means all hardware threads
+    vector<int> Search(const string& text) const;
+  private:
+    bool Matches(const SuffixArray& sufarr, int pos, int query_pos) const; // kangaroo jumps, at most k + 1 lcp queries
+
+    string query;
+    int mismatches;
+    int threads;
 };
 
-long long SubstringsNumber(const string& text);
+class GeneralizedSuffixArray { // one suffix array over a whole collection of documents
+  public:
+    GeneralizedSuffixArray(const vector<string>& docs);
+    int GetDocsNumber() const;
+    int GetDoc(int pos) const; // document that owns a text position
+    vector<int> GetArr() const;
+    vector<int> GetLCP() const;
+    vector<long long> DistinctSubstrings() const; // for every document, one pass over sa + lcp
+    pair<int, int> CommonSubstring(int k) const; // longest substring of any k documents: length and text position
+    vector<int> ListDocuments(const string& pattern) const; // sorted documents that contain the pattern
+  private:
+    static vector<int> JoinDocs(const vector<string>& docs); // separators are document indexes, letters go after them
+    int Compare(int pos, const string& pattern) const; // compares a suffix prefix with the pattern
+
+    int docs_num;
+    vector<int> text; // documents joined by JoinDocs
+    int txt_sz;
+    SuffixArray sufarr; // its own '$' suffix is the smallest, so it goes before all the others
+    std::span<const int> arr; // sufarr without the '$' suffix
+    std::span<const int> lcp; // lcp[i] is the lcp of arr[i] and arr[i + 1]
+    vector<int> doc; // document of every text position
+    vector<int> doc_end; // position of every document's separator
+};
+
+class SuffixAutomaton { // counts distinct substrings of an append-only text
+  public:
+    struct Snapshot {
+      vector<int> nodes; // copy of the node pool
+      int last;
+      long long distinct;
+    };
+    SuffixAutomaton();
+    void Append(char chr); // amortised O(1)
+    long long DistinctSubstrings() const;
+    Snapshot Save() const;
+    void Restore(const Snapshot& snap);
+  private:
+    static const int NODE_SZ = ALPH_LEN + 2; // len, link and transitions of a node
+    int NewNode(int len, int link);
+    int& Len(int node);
+    int& Link(int node);
+    int& Next(int node, int chr);
+
+    vector<int> nodes; // node pool, a node is addressed by its index
+    int last;
+    long long distinct;
+};
+
+class RankBitVector { // bitvector with rank in O(1)
+  public:
+    RankBitVector(int size = 0);
+    void Set(int pos);
+    void Build(); // has to be called after all bits are set
+    bool Get(int pos) const;
+    int Rank1(int pos) const; // ones in [0, pos)
+    int Rank0(int pos) const;
+    long long SizeInBytes() const;
+  private:
+    static const int BLOCK_WORDS = 8; // one counter per 512 bits
+    vector<uint64_t> words;
+    vector<int> blocks; // ones before every block
+};
+
+class FMIndex { // compressed index: bwt in a wavelet matrix and a sampled suffix array
+  public:
+    FMIndex(const string& raw_text, const vector<int>& sufarr, int sample_rate = 32); // sufarr is SuffixArray::GetArr()
+    int Count(const string& pattern) const;
+    vector<int> Locate(const string& pattern) const; // sorted positions of the pattern
+    long long SizeInBytes() const;
+  private:
+    static const int LEVELS = 5; // bits per symbol, '$' is 0 and letters are 1..ALPH_LEN
+    int Rank(int sym, int pos) const; // occurrences of sym in bwt[0, pos)
+    int Access(int pos) const; // bwt[pos]
+    int LF(int pos) const;
+    pair<int, int> Range(const string& pattern) const; // rows whose suffixes start with the pattern
+
+    int txt_sz;
+    int sample_rate;
+    vector<RankBitVector> levels;
+    vector<int> zeros; // zeros on every level of the wavelet matrix
+    vector<int> less; // less[sym] is the number of symbols smaller than sym
+    RankBitVector sampled; // rows with a stored suffix array value
+    vector<int> samples;
+};
+
+template <typename Container>
+long long SubstringsNumber(const Container& text);
 
 int main() {
   string text;
@@ -39,14 +171,15 @@ int main() {
   return 0;
 }
 
-long long SubstringsNumber(const string& text) {
+template <typename Container>
+long long SubstringsNumber(const Container& text) {
   SuffixArray sufarr(text);
   sufarr.BuildLCP();
   long long sum = 0;
-  for (int i : sufarr.GetArr()) {
+  for (int i : sufarr.ArrView()) {
     sum += text.size() - i;
   }
-  for (int i : sufarr.GetLCP()) {
+  for (int i : sufarr.LCPView()) {
     sum -= i;
   }
   return sum;
@@ -64,31 +197,61 @@ vector<int> SuffixArray::GetLCP() const {
   return vector<int>(lcp.begin() + 1, lcp.end() - 1);
 }
 
-SuffixArray::SuffixArray(const string& raw_text) :
-    text(raw_text + '$'),
-    txt_sz(text.size()),
+std::span<const int> SuffixArray::ArrView() const {
+  return std::span<const int>(arr);
+}
+
+std::span<const int> SuffixArray::LCPView() const {
+  return std::span<const int>(lcp).subspan(1, txt_sz - 2);
+}
+
+void SuffixArray::BuildRMQ(bool compact) {
+  lcp_min = RangeMin(lcp, compact);
+}
+
+int SuffixArray::Lcp(int i, int j) const {
+  if (i == j) {
+    return txt_sz - 1 - i;
+  }
+  int left = min(inverse[i], inverse[j]);
+  int right = max(inverse[i], inverse[j]);
+  return lcp_min.Query(left, right - 1); // lcp[k] belongs to arr[k] and arr[k + 1]
+}
+
+template <typename Container>
+SuffixArray::SuffixArray(const Container& raw_text) :
+    txt_sz(raw_text.size() + 1),
     arr(txt_sz),
     new_arr(txt_sz),
     cls(txt_sz),
     new_cls(txt_sz),
-    sort_counter(max(txt_sz, ALPH_LEN + 1)) {
+    sort_counter(txt_sz) {
   if (raw_text.empty()) {
     arr.resize(0);
     return;
   }
+  ReduceRanks(raw_text);
   FirstSort();
   for (int step = 0; (1 << step) < txt_sz; ++step) {
     NextSort(step);
   }
 }
 
+template <typename Container>
+void SuffixArray::ReduceRanks(const Container& raw_text) {
+  vector<typename Container::value_type> alphabet(raw_text.begin(), raw_text.end());
+  sort(alphabet.begin(), alphabet.end());
+  alphabet.erase(unique(alphabet.begin(), alphabet.end()), alphabet.end());
+  text.resize(txt_sz);
+  for (int i = 0; i < txt_sz - 1; ++i) {
+    text[i] = lower_bound(alphabet.begin(), alphabet.end(), raw_text[i]) - alphabet.begin() + 1;
+  }
+  text[txt_sz - 1] = 0; // '$' is smaller than any symbol
+}
+
 void SuffixArray::FirstSort() {
-  for (int i = 0; i < txt_sz; ++i) { // counting sort
-    if (text[i] == '$') {
-      ++sort_counter[0];
-    } else {
-      ++sort_counter[text[i] - 'a' + 1];
-    }
+  for (int i = 0; i < txt_sz; ++i) { // counting sort, ranks are less than txt_sz
+    ++sort_counter[text[i]];
   }
   sort_counter[txt_sz - 1] *= -1; // count offsets for each letter
   sort_counter[txt_sz - 1] += txt_sz;
@@ -96,10 +259,9 @@ void SuffixArray::FirstSort() {
     sort_counter[i] *= -1;
     sort_counter[i] += sort_counter[i + 1];
   }
-  arr[0] = txt_sz - 1;
-  for (int i = 0; i < txt_sz - 1; ++i) {
-    arr[sort_counter[text[i] - 'a' + 1]] = i;
-    ++sort_counter[text[i] - 'a' + 1];
+  for (int i = 0; i < txt_sz; ++i) {
+    arr[sort_counter[text[i]]] = i;
+    ++sort_counter[text[i]];
   }
   cls[arr[0]] = 0;
   int cur_cl = 0;
@@ -113,7 +275,7 @@ void SuffixArray::FirstSort() {
 
 void SuffixArray::NextSort(int step) {
   int len = 1 << step;
-  sort_counter.assign(max(txt_sz, ALPH_LEN + 1), 0);
+  sort_counter.assign(txt_sz, 0);
   for (int i = 0; i < txt_sz; ++i) { // counting sort
     ++sort_counter[cls[Jump(i, len)]];
   }
@@ -124,8 +286,8 @@ void SuffixArray::NextSort(int step) {
     sort_counter[i] += sort_counter[i + 1];
   }
   for (int i = 0; i < txt_sz; ++i) {
-    new_arr[sort_counter[cls[Jump(i, len)]]] = Jump(i, len);
-    ++sort_counter[cls[Jump(i, len)]];
+    int pos = Jump(i, len);
+    new_arr[sort_counter[cls[pos]]++] = pos;
   }
   swap(arr, new_arr); // arr <- new_arr, swapping to conserve time
   new_cls[arr[0]] = 0;
@@ -161,3 +323,485 @@ void SuffixArray::BuildLCP() {
     }
   }
 }
+
+GeneralizedSuffixArray::GeneralizedSuffixArray(const vector<string>& docs) :
+    docs_num(docs.size()),
+    text(JoinDocs(docs)),
+    txt_sz(text.size()),
+    sufarr(text) {
+  doc.reserve(txt_sz);
+  doc_end.reserve(docs_num);
+  for (int i = 0; i < docs_num; ++i) {
+    doc.insert(doc.end(), docs[i].size() + 1, i);
+    doc_end.push_back(doc.size() - 1);
+  }
+  if (txt_sz == 0) {
+    return;
+  }
+  sufarr.BuildLCP();
+  arr = sufarr.ArrView().subspan(1);
+  lcp = sufarr.LCPView();
+}
+
+vector<int> GeneralizedSuffixArray::JoinDocs(const vector<string>& docs) {
+  int docs_num = docs.size();
+  int txt_sz = 0;
+  for (const string& str : docs) {
+    txt_sz += str.size() + 1;
+  }
+  vector<int> text;
+  text.reserve(txt_sz);
+  for (int i = 0; i < docs_num; ++i) {
+    for (char chr : docs[i]) {
+      text.push_back(docs_num + chr - 'a');
+    }
+    text.push_back(i); // every separator is unique, so neither the order nor lcp looks past a document end
+  }
+  return text;
+}
+
+int GeneralizedSuffixArray::GetDocsNumber() const {
+  return docs_num;
+}
+
+int GeneralizedSuffixArray::GetDoc(int pos) const {
+  return doc[pos];
+}
+
+vector<int> GeneralizedSuffixArray::GetArr() const {
+  return vector<int>(arr.begin(), arr.end());
+}
+
+vector<int> GeneralizedSuffixArray::GetLCP() const {
+  return vector<int>(lcp.begin(), lcp.end());
+}
+
+vector<long long> GeneralizedSuffixArray::DistinctSubstrings() const {
+  vector<long long> result(docs_num);
+  vector<int> last(docs_num, -1); // last suffix array index of every document
+  vector<pair<int, int>> mins; // (index, lcp) with increasing lcp, gives range minimums up to the current index
+  for (int i = docs_num; i < txt_sz; ++i) { // separators are the first docs_num suffixes
+    int pos = arr[i];
+    int cur_doc = doc[pos];
+    result[cur_doc] += doc_end[cur_doc] - pos;
+    while (!mins.empty() && mins.back().second >= lcp[i - 1]) {
+      mins.pop_back();
+    }
+    mins.emplace_back(i, lcp[i - 1]);
+    if (last[cur_doc] != -1) { // subtract the lcp with the previous suffix of the same document
+      auto it = std::lower_bound(mins.begin(), mins.end(), pair<int, int>(last[cur_doc] + 1, -1));
+      result[cur_doc] -= it->second;
+    }
+    last[cur_doc] = i;
+  }
+  return result;
+}
+
+pair<int, int> GeneralizedSuffixArray::CommonSubstring(int k) const {
+  pair<int, int> best(0, -1);
+  if (k < 1 || k > docs_num) {
+    return best;
+  }
+  vector<int> in_window(docs_num);
+  std::deque<int> window_min; // lcp indexes with increasing lcp
+  int distinct = 0;
+  int left = docs_num;
+  for (int right = docs_num; right < txt_sz; ++right) { // two pointers over the suffix array
+    if (in_window[doc[arr[right]]]++ == 0) {
+      ++distinct;
+    }
+    if (right > left) {
+      while (!window_min.empty() && lcp[window_min.back()] >= lcp[right - 1]) {
+        window_min.pop_back();
+      }
+      window_min.push_back(right - 1);
+    }
+    while (in_window[doc[arr[left]]] > 1 || (distinct > k && left < right)) { // shrink while k documents remain
+      if (--in_window[doc[arr[left]]] == 0) {
+        --distinct;
+      }
+      ++left;
+    }
+    while (!window_min.empty() && window_min.front() < left) {
+      window_min.pop_front();
+    }
+    if (distinct >= k) {
+      int len = (left == right) ? doc_end[doc[arr[right]]] - arr[right] : lcp[window_min.front()];
+      if (len > best.first) {
+        best = pair<int, int>(len, arr[right]);
+      }
+    }
+  }
+  return best;
+}
+
+int GeneralizedSuffixArray::Compare(int pos, const string& pattern) const {
+  for (int i = 0; i < static_cast<int>(pattern.size()); ++i) {
+    int chr = docs_num + pattern[i] - 'a';
+    if (text[pos + i] != chr) { // a separator is met before the end of text
+      return text[pos + i] < chr ? -1 : 1;
+    }
+  }
+  return 0;
+}
+
+vector<int> GeneralizedSuffixArray::ListDocuments(const string& pattern) const {
+  int left = docs_num;
+  int right = txt_sz;
+  while (left < right) { // first suffix that is not less than the pattern
+    int mid = (left + right) / 2;
+    if (Compare(arr[mid], pattern) < 0) {
+      left = mid + 1;
+    } else {
+      right = mid;
+    }
+  }
+  int first = left;
+  right = txt_sz;
+  while (left < right) { // first suffix that doesn't start with the pattern
+    int mid = (left + right) / 2;
+    if (Compare(arr[mid], pattern) == 0) {
+      left = mid + 1;
+    } else {
+      right = mid;
+    }
+  }
+  vector<int> result;
+  result.reserve(left - first);
+  for (int i = first; i < left; ++i) {
+    result.push_back(doc[arr[i]]);
+  }
+  sort(result.begin(), result.end());
+  result.erase(unique(result.begin(), result.end()), result.end());
+  return result;
+}
+
+SuffixAutomaton::SuffixAutomaton() :
+    last(0),
+    distinct(0) {
+  NewNode(0, -1);
+}
+
+int SuffixAutomaton::NewNode(int len, int link) {
+  int node = nodes.size() / NODE_SZ;
+  nodes.resize(nodes.size() + NODE_SZ, -1);
+  Len(node) = len;
+  Link(node) = link;
+  return node;
+}
+
+int& SuffixAutomaton::Len(int node) {
+  return nodes[node * NODE_SZ];
+}
+
+int& SuffixAutomaton::Link(int node) {
+  return nodes[node * NODE_SZ + 1];
+}
+
+int& SuffixAutomaton::Next(int node, int chr) {
+  return nodes[node * NODE_SZ + 2 + chr];
+}
+
+void SuffixAutomaton::Append(char chr) {
+  int sym = chr - 'a';
+  int cur = NewNode(Len(last) + 1, 0);
+  int prev = last;
+  while (prev != -1 && Next(prev, sym) == -1) { // add transitions to the new state
+    Next(prev, sym) = cur;
+    prev = Link(prev);
+  }
+  if (prev != -1) {
+    int nxt = Next(prev, sym);
+    if (Len(prev) + 1 == Len(nxt)) {
+      Link(cur) = nxt;
+    } else { // split nxt, clones don't change the number of substrings
+      int clone = NewNode(Len(prev) + 1, Link(nxt));
+      std::copy(nodes.begin() + nxt * NODE_SZ + 2, nodes.begin() + (nxt + 1) * NODE_SZ, nodes.begin() + clone * NODE_SZ + 2);
+      while (prev != -1 && Next(prev, sym) == nxt) {
+        Next(prev, sym) = clone;
+        prev = Link(prev);
+      }
+      Link(nxt) = Link(cur) = clone;
+    }
+  }
+  distinct += Len(cur) - Len(Link(cur)); // new substrings are the suffixes that end only here
+  last = cur;
+}
+
+long long SuffixAutomaton::DistinctSubstrings() const {
+  return distinct;
+}
+
+SuffixAutomaton::Snapshot SuffixAutomaton::Save() const {
+  return Snapshot{nodes, last, distinct};
+}
+
+void SuffixAutomaton::Restore(const Snapshot& snap) {
+  nodes = snap.nodes;
+  last = snap.last;
+  distinct = snap.distinct;
+}
+
+RankBitVector::RankBitVector(int size) :
+    words((size + 63) / 64) {
+
+}
+
+void RankBitVector::Set(int pos) {
+  words[pos / 64] |= uint64_t(1) << (pos % 64);
+}
+
+void RankBitVector::Build() {
+  blocks.resize(words.size() / BLOCK_WORDS + 1);
+  int ones = 0;
+  for (int i = 0; i < static_cast<int>(words.size()); ++i) {
+    if (i % BLOCK_WORDS == 0) {
+      blocks[i / BLOCK_WORDS] = ones;
+    }
+    ones += __builtin_popcountll(words[i]);
+  }
+  if (words.size() % BLOCK_WORDS == 0) {
+    blocks.back() = ones;
+  }
+}
+
+bool RankBitVector::Get(int pos) const {
+  return (words[pos / 64] >> (pos % 64)) & 1;
+}
+
+int RankBitVector::Rank1(int pos) const {
+  int word = pos / 64;
+  int result = blocks[word / BLOCK_WORDS];
+  for (int i = word - word % BLOCK_WORDS; i < word; ++i) {
+    result += __builtin_popcountll(words[i]);
+  }
+  if (pos % 64) {
+    result += __builtin_popcountll(words[word] << (64 - pos % 64));
+  }
+  return result;
+}
+
+int RankBitVector::Rank0(int pos) const {
+  return pos - Rank1(pos);
+}
+
+long long RankBitVector::SizeInBytes() const {
+  return words.size() * sizeof(uint64_t) + blocks.size() * sizeof(int);
+}
+
+FMIndex::FMIndex(const string& raw_text, const vector<int>& sufarr, int sample_rate) :
+    txt_sz(sufarr.size()),
+    sample_rate(sample_rate),
+    levels(LEVELS, RankBitVector(txt_sz)),
+    zeros(LEVELS),
+    less(ALPH_LEN + 2),
+    sampled(txt_sz) {
+  vector<int> bwt(txt_sz);
+  for (int i = 0; i < txt_sz; ++i) { // the symbol before every suffix, '$' before the whole text
+    bwt[i] = sufarr[i] ? raw_text[sufarr[i] - 1] - 'a' + 1 : 0;
+    ++less[bwt[i] + 1];
+    if (sufarr[i] % sample_rate == 0) {
+      sampled.Set(i);
+      samples.push_back(sufarr[i]);
+    }
+  }
+  for (int i = 1; i < ALPH_LEN + 2; ++i) {
+    less[i] += less[i - 1];
+  }
+  sampled.Build();
+  vector<int> next(txt_sz);
+  for (int lvl = 0; lvl < LEVELS; ++lvl) { // stable partition by every bit, starting from the highest
+    int bit = LEVELS - 1 - lvl;
+    for (int i = 0; i < txt_sz; ++i) {
+      if ((bwt[i] >> bit) & 1) {
+        levels[lvl].Set(i);
+      } else {
+        ++zeros[lvl];
+      }
+    }
+    levels[lvl].Build();
+    int zero_ptr = 0;
+    int one_ptr = zeros[lvl];
+    for (int i = 0; i < txt_sz; ++i) {
+      next[((bwt[i] >> bit) & 1) ? one_ptr++ : zero_ptr++] = bwt[i];
+    }
+    swap(bwt, next);
+  }
+}
+
+int FMIndex::Rank(int sym, int pos) const {
+  int beg = 0;
+  for (int lvl = 0; lvl < LEVELS; ++lvl) {
+    if ((sym >> (LEVELS - 1 - lvl)) & 1) {
+      beg = zeros[lvl] + levels[lvl].Rank1(beg);
+      pos = zeros[lvl] + levels[lvl].Rank1(pos);
+    } else {
+      beg = levels[lvl].Rank0(beg);
+      pos = levels[lvl].Rank0(pos);
+    }
+  }
+  return pos - beg;
+}
+
+int FMIndex::Access(int pos) const {
+  int sym = 0;
+  for (int lvl = 0; lvl < LEVELS; ++lvl) {
+    sym <<= 1;
+    if (levels[lvl].Get(pos)) {
+      sym |= 1;
+      pos = zeros[lvl] + levels[lvl].Rank1(pos);
+    } else {
+      pos = levels[lvl].Rank0(pos);
+    }
+  }
+  return sym;
+}
+
+int FMIndex::LF(int pos) const {
+  int sym = Access(pos);
+  return less[sym] + Rank(sym, pos);
+}
+
+pair<int, int> FMIndex::Range(const string& pattern) const {
+  int beg = 0;
+  int end = txt_sz;
+  for (int i = pattern.size() - 1; i >= 0 && beg < end; --i) { // backward search
+    int sym = pattern[i] - 'a' + 1;
+    beg = less[sym] + Rank(sym, beg);
+    end = less[sym] + Rank(sym, end);
+  }
+  return pair<int, int>(beg, end);
+}
+
+int FMIndex::Count(const string& pattern) const {
+  pair<int, int> range = Range(pattern);
+  return max(0, range.second - range.first);
+}
+
+vector<int> FMIndex::Locate(const string& pattern) const {
+  pair<int, int> range = Range(pattern);
+  vector<int> result;
+  for (int i = range.first; i < range.second; ++i) {
+    int row = i;
+    int steps = 0;
+    while (!sampled.Get(row)) { // at most sample_rate - 1 steps back through the text
+      row = LF(row);
+      ++steps;
+    }
+    result.push_back(samples[sampled.Rank1(row)] + steps);
+  }
+  sort(result.begin(), result.end());
+  return result;
+}
+
+long long FMIndex::SizeInBytes() const {
+  long long size = sampled.SizeInBytes() + samples.size() * sizeof(int) + (zeros.size() + less.size()) * sizeof(int);
+  for (const RankBitVector& lvl : levels) {
+    size += lvl.SizeInBytes();
+  }
+  return size;
+}
+
+RangeMin::RangeMin(std::span<const int> values, bool compact) :
+    values(values) {
+  int size = values.size();
+  if (compact) {
+    while ((1 << block) < size) { // block of about log(n) elements
+      ++block;
+    }
+    prefix.resize(size);
+    suffix.resize(size);
+    for (int i = 0; i < size; ++i) {
+      prefix[i] = (i % block) ? min(prefix[i - 1], values[i]) : values[i];
+    }
+    for (int i = size - 1; i >= 0; --i) {
+      suffix[i] = ((i + 1) % block && i + 1 < size) ? min(suffix[i + 1], values[i]) : values[i];
+    }
+  }
+  int blocks = (size + block - 1) / block;
+  table.emplace_back(blocks);
+  for (int i = 0; i < blocks; ++i) {
+    table[0][i] = compact ? suffix[i * block] : values[i];
+  }
+  for (int k = 1; (1 << k) <= blocks; ++k) {
+    table.emplace_back(blocks - (1 << k) + 1);
+    for (int i = 0; i + (1 << k) <= blocks; ++i) {
+      table[k][i] = min(table[k - 1][i], table[k - 1][i + (1 << (k - 1))]);
+    }
+  }
+}
+
+int RangeMin::TableQuery(int left, int right) const {
+  int k = 31 - __builtin_clz(right - left + 1);
+  return min(table[k][left], table[k][right - (1 << k) + 1]);
+}
+
+int RangeMin::Query(int left, int right) const {
+  if (block == 1) {
+    return TableQuery(left, right);
+  }
+  int left_block = left / block;
+  int right_block = right / block;
+  if (left_block == right_block) { // naive scan inside one block
+    int result = values[left];
+    for (int i = left + 1; i <= right; ++i) {
+      result = min(result, values[i]);
+    }
+    return result;
+  }
+  int result = min(suffix[left], prefix[right]);
+  if (right_block - left_block > 1) {
+    result = min(result, TableQuery(left_block + 1, right_block - 1));
+  }
+  return result;
+}
+
+MismatchSearcher::MismatchSearcher(const string& query, int mismatches, int threads) :
+    query(query),
+    mismatches(mismatches),
+    threads(threads ? threads : max(1U, std::thread::hardware_concurrency())) {
+
+}
+
+bool MismatchSearcher::Matches(const SuffixArray& sufarr, int pos, int query_pos) const {
+  int qr_sz = query.size();
+  int matched = 0;
+  for (int errors = 0; errors <= mismatches; ++errors) {
+    matched += sufarr.Lcp(pos + matched, query_pos + matched); // jump over the matching part
+    if (matched >= qr_sz) {
+      return true;
+    }
+    ++matched; // skip the mismatch
+  }
+  return false;
+}
+
+vector<int> MismatchSearcher::Search(const string& text) const {
+  int txt_sz = text.size();
+  int qr_sz = query.size();
+  if (txt_sz < qr_sz) {
+    return vector<int>();
+  }
+  SuffixArray sufarr(text + '#' + query); // '#' stops every lcp at the end of text
+  sufarr.BuildLCP();
+  sufarr.BuildRMQ();
+  int aligns = txt_sz - qr_sz + 1;
+  int workers = min(threads, aligns);
+  vector<vector<int>> found(workers);
+  vector<std::thread> pool;
+  for (int w = 0; w < workers; ++w) { // every worker checks its own block of alignments
+    pool.emplace_back([&, w]() {
+      for (int i = static_cast<long long>(aligns) * w / workers; i < static_cast<long long>(aligns) * (w + 1) / workers; ++i) {
+        if (Matches(sufarr, i, txt_sz + 1)) {
+          found[w].push_back(i);
+        }
+      }
+    });
+  }
+  vector<int> entries;
+  for (int w = 0; w < workers; ++w) {
+    pool[w].join();
+    entries.insert(entries.end(), found[w].begin(), found[w].end());
+  }
+  return entries;
+}
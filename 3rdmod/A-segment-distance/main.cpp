@@ -2,28 +2,27 @@
 #include <iomanip>
 #include <cmath>
 #include <limits>
+#include <vector>
+#include <algorithm>
+#include <utility>
+#include "../geometry.h"
+#include "../predicates.h"
+#include "../pointio.h"
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
 
-using std::istream;
-using std::ostream;
 using std::min;
+using std::max;
+using std::vector;
+using std::pair;
 
-static const double MAX_COORD = 1000;
 static const double EPS = std::numeric_limits<double>::epsilon();
+static const int BVH_LEAF_SIZE = 4;
+static const int BVH_BINS = 16;
 
-class Point {
-  public:
-    Point();
-    Point(double x, double y, double z);
-    double GetX() const;
-    double GetY() const;
-    double GetZ() const;
-    friend istream& operator>>(istream& in, Point& point);
-    friend ostream& operator<<(ostream& out, const Point& point);
-  private:
-    double x;
-    double y;
-    double z;
-};
+typedef BasicPoint<double, 3> Point;
+typedef BasicVector<double, 3> Vector;
 
 class Segment {
   public:
@@ -37,34 +36,7 @@ class Segment {
     Point end;
 };
 
-class Vector {
-  public:
-    Vector();
-    Vector(double x, double y, double z);
-    Vector(const Point& begin, const Point& end);
-    explicit Vector(const Point& point);
-    explicit Vector(const Segment& seg);
-    double GetX() const;
-    double GetY() const;
-    double GetZ() const;
-    double GetLength() const;
-    Vector& operator*=(double mod);
-    friend Vector operator*(Vector vec, double mod);
-    friend Vector operator*(double mod, const Vector& vec);
-    Vector& operator+=(const Vector& other);
-    friend Vector operator+(Vector lhs, const Vector& rhs);
-    Vector& operator-=(const Vector& other);
-    friend Vector operator-(Vector lhs, const Vector& rhs);
-    friend istream& operator>>(istream& in, Vector& vec);
-    friend ostream& operator<<(ostream& out, const Vector& vec);
-  private:
-    double x;
-    double y;
-    double z;
-};
-
-double DotProduct(const Vector& first_vec, const Vector& second_vec);
-
+bool Parallel(const Segment& first_seg, const Segment& second_seg); // точная проверка a x b = 0 по трём проекциям
 double SystemSolve(const Vector& r01, const Vector& a, const Vector& r02, const Vector& b);
 void CheckBoundaryTs(const Segment& first_seg, const Segment& second_seg, double& curr_min);
 void UpdateIfSecondSegIsNotAPointAndTIsOne(const Vector& r02, const Vector& r11, const Vector& b, double t2, double& curr_min);
@@ -72,17 +44,77 @@ void UpdateIfSecondSegIsNotAPointAndTIsZero(const Vector& r01, const Vector& r02
 
 double SegmentDistance(const Segment& first_seg, const Segment& second_seg);
 
-int main() {
-  Point a0, a1, b0, b1;
-  std::cin >> a0 >> a1 >> b0 >> b1;
+struct SegmentsSoA { // отрезки структурой массивов для пакетного подсчёта расстояний
+  SegmentsSoA(const vector<Segment>& segs);
+  int size;
+  vector<double> begin_x;
+  vector<double> begin_y;
+  vector<double> begin_z;
+  vector<double> end_x;
+  vector<double> end_y;
+  vector<double> end_z;
+};
+
+double ClampedDistance(const SegmentsSoA& first, const SegmentsSoA& second, int i); // без ветвлений: минимум по внутреннему решению и четырём концам, параметры зажаты в [0, 1]
+void SegmentDistances(const SegmentsSoA& first, const SegmentsSoA& second, double* result); // result[i] - расстояние между i-ми отрезками, по 4 пары за раз на AVX2; погрешность ~1e-15 от масштаба координат
+
+struct Box { // ограничивающий параллелепипед со сторонами вдоль осей
+  Box(); // пустой
+  explicit Box(const Segment& seg);
+  void Add(const Box& other);
+  double Area() const; // половина площади поверхности, для SAH
+  double lo[3];
+  double hi[3];
+};
+
+double BoxGap(const Box& first, const Box& second); // квадрат расстояния между параллелепипедами, нижняя оценка для отрезков внутри
+
+class SegmentBVH { // иерархия параллелепипедов над отрезками, разбиения по SAH на корзинах; строится один раз для многих запросов
+  public:
+    explicit SegmentBVH(const vector<Segment>& segs);
+    int Size() const;
+    bool ClosestPair(int& first, int& second, double& dist) const; // false, если отрезков меньше двух
+    vector<pair<double, int>> Nearest(const Segment& query, int k) const; // k ближайших (расстояние, номер) по возрастанию расстояния
+    vector<pair<double, int>> Nearest(const Point& query, int k) const;
+  private:
+    struct Node {
+      Box box;
+      int first; // у листа - первый отрезок, у внутреннего узла - левый потомок, правый следом
+      int count; // 0 у внутреннего узла
+    };
+
+    void Split(int node, int begin, int end);
+    void Search(const Segment& query, const Box& query_box, int skip, size_t k, double bound, vector<pair<double, int>>& best) const; // best - куча по убыванию, ветви дальше bound отсекаются
+
+    vector<Segment> segs; // в порядке листьев
+    vector<Box> boxes;
+    vector<int> ids; // исходные номера
+    vector<Node> nodes;
+};
+
+int main(int argc, char** argv) { // --f64/--f32 - бинарный ввод
+  InputReader reader(FormatFromArgs(argc, argv));
+  double coords[12] = {};
+  if (!reader.ReadCoords(coords, 12)) {
+    std::cerr << "bad input\n";
+    return 1;
+  }
+  Point a0(coords[0], coords[1], coords[2]);
+  Point a1(coords[3], coords[4], coords[5]);
+  Point b0(coords[6], coords[7], coords[8]);
+  Point b1(coords[9], coords[10], coords[11]);
   std::cout << std::fixed << std::setprecision(8) << SegmentDistance(Segment(a0, a1), Segment(b0, b1)) << std::endl;
   return 0;
 }
 
-double DotProduct(const Vector& first_vec, const Vector& second_vec) {
-  return first_vec.GetX() * second_vec.GetX() +
-         first_vec.GetY() * second_vec.GetY() +
-         first_vec.GetZ() * second_vec.GetZ();
+bool Parallel(const Segment& first_seg, const Segment& second_seg) {
+  const Point& a0 = first_seg.GetBegin();
+  const Point& a1 = first_seg.GetEnd();
+  const Point& b0 = second_seg.GetBegin();
+  const Point& b1 = second_seg.GetEnd();
+  return !CrossSign(a0.GetX(), a0.GetY(), a1.GetX(), a1.GetY(), b0.GetX(), b0.GetY(), b1.GetX(), b1.GetY()) &&
+         !CrossSign(a0.GetY(), a0.GetZ(), a1.GetY(), a1.GetZ(), b0.GetY(), b0.GetZ(), b1.GetY(), b1.GetZ()) &&
+         !CrossSign(a0.GetZ(), a0.GetX(), a1.GetZ(), a1.GetX(), b0.GetZ(), b0.GetX(), b1.GetZ(), b1.GetX());
 }
 
 double SystemSolve(const Vector& r01, const Vector& a, const Vector& r02, const Vector& b) {
@@ -114,7 +146,7 @@ void CheckBoundaryTs(const Segment& first_seg, const Segment& second_seg, double
   Vector r01 = Vector(first_seg.GetBegin()); // радиус-вектор начала первого отрезка
   Vector r02 = Vector(second_seg.GetBegin());
   Vector r11 = Vector(first_seg.GetEnd()); // радиус-вектор конца первого отрезка
-  Vector b = Vector(second_seg); // второй направляющий вектор
+  Vector b = Vector(second_seg.GetBegin(), second_seg.GetEnd()); // второй направляющий вектор
   double t2;
   t2 = DotProduct(r11 - r02, b) / DotProduct(b, b);
   if (t2 - 1 <= EPS && t2 >= -EPS) {
@@ -131,13 +163,12 @@ void CheckBoundaryTs(const Segment& first_seg, const Segment& second_seg, double
 }
 
 double SegmentDistance(const Segment& first_seg, const Segment& second_seg) {
-  const double max_vec_len = 2 * Vector(MAX_COORD, MAX_COORD, MAX_COORD).GetLength();
   Vector r01 = Vector(first_seg.GetBegin()); // радиус-вектор начала первого отрезка
   Vector r02 = Vector(second_seg.GetBegin());
-  Vector a = Vector(first_seg); // первый напрвляющий вектор
-  Vector b = Vector(second_seg); // второй направляющий вектор
-  double curr_min = max_vec_len;
-  double system_answer = SystemSolve(r01, a, r02, b); // находим минимальное расстояние через поиск экстремумов функции len(dr), где dr = r01 + t1 * a - r02 - t2 * b
+  Vector a = Vector(first_seg.GetBegin(), first_seg.GetEnd()); // первый напрвляющий вектор
+  Vector b = Vector(second_seg.GetBegin(), second_seg.GetEnd()); // второй направляющий вектор
+  double curr_min = std::numeric_limits<double>::infinity(); // без верхней границы координат: дальние отрезки не обрезаются
+  double system_answer = Parallel(first_seg, second_seg) ? -1 : SystemSolve(r01, a, r02, b); // находим минимальное расстояние через поиск экстремумов функции len(dr), где dr = r01 + t1 * a - r02 - t2 * b
   if (system_answer != -1) {
     curr_min = min(curr_min, system_answer);
   }
@@ -153,153 +184,367 @@ double SegmentDistance(const Segment& first_seg, const Segment& second_seg) {
   return curr_min;
 }
 
-Point::Point() :
-    x(0),
-    y(0),
-    z(0) {
-
-}
-
-Point::Point(double x, double y, double z) :
-    x(x),
-    y(y),
-    z(z) {
-
-}
-
-double Point::GetX() const {
-  return x;
-}
-
-double Point::GetY() const {
-  return y;
-}
-
-double Point::GetZ() const {
-  return z;
-}
-
-istream& operator>>(istream& in, Point& point) {
-  in >> point.x >> point.y >> point.z;
-  return in;
-}
-
-ostream& operator<<(ostream& out, const Point& point) {
-  out << point.x << " " << point.y << " " << point.z;
-  return out;
-}
-
-Segment::Segment(const Point& begin, const Point& end) :
-    begin(begin),
-    end(end) {
-
-}
-
-const Point& Segment::GetBegin() const {
-  return begin;
-}
-
-const Point& Segment::GetEnd() const {
-  return end;
-}
-
-double Segment::GetLength() const {
-  return Vector(*this).GetLength();
+SegmentsSoA::SegmentsSoA(const vector<Segment>& segs) :
+    size(segs.size()),
+    begin_x(size),
+    begin_y(size),
+    begin_z(size),
+    end_x(size),
+    end_y(size),
+    end_z(size) {
+  for (int i = 0; i < size; ++i) {
+    begin_x[i] = segs[i].GetBegin().GetX();
+    begin_y[i] = segs[i].GetBegin().GetY();
+    begin_z[i] = segs[i].GetBegin().GetZ();
+    end_x[i] = segs[i].GetEnd().GetX();
+    end_y[i] = segs[i].GetEnd().GetY();
+    end_z[i] = segs[i].GetEnd().GetZ();
+  }
 }
 
-Vector::Vector() :
-    x(0),
-    y(0),
-    z(0) {
-
+static double Clamp(double t) {
+  return min(max(t, 0.0), 1.0);
+}
+
+double ClampedDistance(const SegmentsSoA& first, const SegmentsSoA& second, int i) {
+  double ax = first.end_x[i] - first.begin_x[i]; // dr = r + s * a - t * b
+  double ay = first.end_y[i] - first.begin_y[i];
+  double az = first.end_z[i] - first.begin_z[i];
+  double bx = second.end_x[i] - second.begin_x[i];
+  double by = second.end_y[i] - second.begin_y[i];
+  double bz = second.end_z[i] - second.begin_z[i];
+  double rx = first.begin_x[i] - second.begin_x[i];
+  double ry = first.begin_y[i] - second.begin_y[i];
+  double rz = first.begin_z[i] - second.begin_z[i];
+  double aa = ax * ax + ay * ay + az * az;
+  double bb = bx * bx + by * by + bz * bz;
+  double ab = ax * bx + ay * by + az * bz;
+  double ar = ax * rx + ay * ry + az * rz;
+  double br = bx * rx + by * ry + bz * rz;
+  double det = aa * bb - ab * ab;
+  double safe_det = det > 0 ? det : 1; // вырожденные знаменатели дают лишь заведомо достижимую пару точек
+  double safe_aa = aa > 0 ? aa : 1;
+  double safe_bb = bb > 0 ? bb : 1;
+  double ss[5] = {Clamp((ab * br - ar * bb) / safe_det), 0, 1, Clamp(-ar / safe_aa), Clamp((ab - ar) / safe_aa)};
+  double ts[5] = {Clamp((aa * br - ab * ar) / safe_det), Clamp(br / safe_bb), Clamp((br + ab) / safe_bb), 0, 1};
+  double best = std::numeric_limits<double>::infinity();
+  for (int k = 0; k < 5; ++k) { // каждая пара (s, t) достижима, а одна из них - точный минимум
+    double dx = rx + ss[k] * ax - ts[k] * bx;
+    double dy = ry + ss[k] * ay - ts[k] * by;
+    double dz = rz + ss[k] * az - ts[k] * bz;
+    best = min(best, dx * dx + dy * dy + dz * dz);
+  }
+  return sqrt(best);
 }
 
-Vector::Vector(double x, double y, double z) :
-    x(x),
-    y(y),
-    z(z) {
-
+#ifdef __AVX2__
+static __m256d Clamp(__m256d t) {
+  return _mm256_min_pd(_mm256_max_pd(t, _mm256_setzero_pd()), _mm256_set1_pd(1));
 }
 
-Vector::Vector(const Point& begin, const Point& end) :
-    x(end.GetX() - begin.GetX()),
-    y(end.GetY() - begin.GetY()),
-    z(end.GetZ() - begin.GetZ()) {
-
+static __m256d SafeDivisor(__m256d val) { // неположительный знаменатель заменяется единицей
+  return _mm256_blendv_pd(_mm256_set1_pd(1), val, _mm256_cmp_pd(val, _mm256_setzero_pd(), _CMP_GT_OQ));
 }
 
-Vector::Vector(const Point& point) :
-    Vector(Point(), point) {
-
+static __m256d SquaredGap(const __m256d (&r)[3], const __m256d (&a)[3], const __m256d (&b)[3], __m256d s, __m256d t) {
+  __m256d len = _mm256_setzero_pd();
+  for (int k = 0; k < 3; ++k) {
+    __m256d d = _mm256_sub_pd(_mm256_add_pd(r[k], _mm256_mul_pd(s, a[k])), _mm256_mul_pd(t, b[k]));
+    len = _mm256_add_pd(len, _mm256_mul_pd(d, d));
+  }
+  return len;
+}
+
+static __m256d Dot(const __m256d (&u)[3], const __m256d (&v)[3]) {
+  return _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(u[0], v[0]), _mm256_mul_pd(u[1], v[1])), _mm256_mul_pd(u[2], v[2]));
+}
+#endif
+
+void SegmentDistances(const SegmentsSoA& first, const SegmentsSoA& second, double* result) {
+  int size = min(first.size, second.size);
+  int i = 0;
+#ifdef __AVX2__
+  const __m256d zero = _mm256_setzero_pd();
+  const __m256d one = _mm256_set1_pd(1);
+  for (; i + 4 <= size; i += 4) { // те же пять кандидатов, что и в ClampedDistance, для пар i..i+3
+    __m256d first_begin[3] = {_mm256_loadu_pd(&first.begin_x[i]), _mm256_loadu_pd(&first.begin_y[i]), _mm256_loadu_pd(&first.begin_z[i])};
+    __m256d second_begin[3] = {_mm256_loadu_pd(&second.begin_x[i]), _mm256_loadu_pd(&second.begin_y[i]), _mm256_loadu_pd(&second.begin_z[i])};
+    __m256d a[3] = {_mm256_sub_pd(_mm256_loadu_pd(&first.end_x[i]), first_begin[0]),
+                    _mm256_sub_pd(_mm256_loadu_pd(&first.end_y[i]), first_begin[1]),
+                    _mm256_sub_pd(_mm256_loadu_pd(&first.end_z[i]), first_begin[2])};
+    __m256d b[3] = {_mm256_sub_pd(_mm256_loadu_pd(&second.end_x[i]), second_begin[0]),
+                    _mm256_sub_pd(_mm256_loadu_pd(&second.end_y[i]), second_begin[1]),
+                    _mm256_sub_pd(_mm256_loadu_pd(&second.end_z[i]), second_begin[2])};
+    __m256d r[3] = {_mm256_sub_pd(first_begin[0], second_begin[0]),
+                    _mm256_sub_pd(first_begin[1], second_begin[1]),
+                    _mm256_sub_pd(first_begin[2], second_begin[2])};
+    __m256d aa = Dot(a, a);
+    __m256d bb = Dot(b, b);
+    __m256d ab = Dot(a, b);
+    __m256d ar = Dot(a, r);
+    __m256d br = Dot(b, r);
+    __m256d inv_det = _mm256_div_pd(one, SafeDivisor(_mm256_sub_pd(_mm256_mul_pd(aa, bb), _mm256_mul_pd(ab, ab))));
+    __m256d inv_aa = _mm256_div_pd(one, SafeDivisor(aa));
+    __m256d inv_bb = _mm256_div_pd(one, SafeDivisor(bb));
+    __m256d inner_s = Clamp(_mm256_mul_pd(_mm256_sub_pd(_mm256_mul_pd(ab, br), _mm256_mul_pd(ar, bb)), inv_det));
+    __m256d inner_t = Clamp(_mm256_mul_pd(_mm256_sub_pd(_mm256_mul_pd(aa, br), _mm256_mul_pd(ab, ar)), inv_det));
+    __m256d best = SquaredGap(r, a, b, inner_s, inner_t);
+    best = _mm256_min_pd(best, SquaredGap(r, a, b, zero, Clamp(_mm256_mul_pd(br, inv_bb))));
+    best = _mm256_min_pd(best, SquaredGap(r, a, b, one, Clamp(_mm256_mul_pd(_mm256_add_pd(br, ab), inv_bb))));
+    best = _mm256_min_pd(best, SquaredGap(r, a, b, Clamp(_mm256_mul_pd(_mm256_sub_pd(zero, ar), inv_aa)), zero));
+    best = _mm256_min_pd(best, SquaredGap(r, a, b, Clamp(_mm256_mul_pd(_mm256_sub_pd(ab, ar), inv_aa)), one));
+    _mm256_storeu_pd(result + i, _mm256_sqrt_pd(best));
+  }
+#endif
+  for (; i < size; ++i) {
+    result[i] = ClampedDistance(first, second, i);
+  }
 }
 
-Vector::Vector(const Segment& seg) :
-    Vector(seg.GetBegin(), seg.GetEnd()) {
-
+Box::Box() {
+  for (int axis = 0; axis < 3; ++axis) {
+    lo[axis] = std::numeric_limits<double>::infinity();
+    hi[axis] = -std::numeric_limits<double>::infinity();
+  }
 }
 
-double Vector::GetX() const {
-  return x;
+Box::Box(const Segment& seg) {
+  for (int axis = 0; axis < 3; ++axis) {
+    lo[axis] = min(seg.GetBegin().GetCoord(axis), seg.GetEnd().GetCoord(axis));
+    hi[axis] = max(seg.GetBegin().GetCoord(axis), seg.GetEnd().GetCoord(axis));
+  }
 }
 
-double Vector::GetY() const {
-  return y;
+void Box::Add(const Box& other) {
+  for (int axis = 0; axis < 3; ++axis) {
+    lo[axis] = min(lo[axis], other.lo[axis]);
+    hi[axis] = max(hi[axis], other.hi[axis]);
+  }
 }
 
-double Vector::GetZ() const {
-  return z;
+double Box::Area() const {
+  if (lo[0] > hi[0]) {
+    return 0;
+  }
+  double dx = hi[0] - lo[0];
+  double dy = hi[1] - lo[1];
+  double dz = hi[2] - lo[2];
+  return dx * dy + dy * dz + dz * dx;
 }
 
-double Vector::GetLength() const {
-  return sqrt(x * x + y * y + z * z);
+double BoxGap(const Box& first, const Box& second) {
+  double gap = 0;
+  for (int axis = 0; axis < 3; ++axis) {
+    double d = max(max(first.lo[axis] - second.hi[axis], second.lo[axis] - first.hi[axis]), 0.0);
+    gap += d * d;
+  }
+  return gap;
 }
 
-Vector& Vector::operator*=(double mod) {
-  x *= mod;
-  y *= mod;
-  z *= mod;
-  return *this;
+SegmentBVH::SegmentBVH(const vector<Segment>& segs) :
+    segs(segs),
+    boxes(segs.size()),
+    ids(segs.size()) {
+  for (size_t i = 0; i < segs.size(); ++i) {
+    boxes[i] = Box(segs[i]);
+    ids[i] = i;
+  }
+  nodes.reserve(2 * segs.size() / BVH_LEAF_SIZE + 1);
+  nodes.push_back(Node());
+  Split(0, 0, segs.size());
+  vector<Segment> ordered;
+  vector<Box> ordered_boxes;
+  ordered.reserve(segs.size());
+  ordered_boxes.reserve(segs.size());
+  for (int id : ids) { // отрезки листа лежат подряд
+    ordered.push_back(segs[id]);
+    ordered_boxes.push_back(boxes[id]);
+  }
+  this->segs.swap(ordered);
+  boxes.swap(ordered_boxes);
+}
+
+void SegmentBVH::Split(int node, int begin, int end) {
+  Box box;
+  Box centers;
+  for (int i = begin; i < end; ++i) {
+    box.Add(boxes[ids[i]]);
+    Box center;
+    for (int axis = 0; axis < 3; ++axis) {
+      center.lo[axis] = center.hi[axis] = (boxes[ids[i]].lo[axis] + boxes[ids[i]].hi[axis]) / 2;
+    }
+    centers.Add(center);
+  }
+  nodes[node].box = box;
+  nodes[node].first = begin;
+  nodes[node].count = end - begin;
+  if (end - begin <= BVH_LEAF_SIZE) {
+    return;
+  }
+  int axis = 0;
+  for (int k = 1; k < 3; ++k) { // ось наибольшего разброса центров
+    if (centers.hi[k] - centers.lo[k] > centers.hi[axis] - centers.lo[axis]) {
+      axis = k;
+    }
+  }
+  double lo = centers.lo[axis];
+  double extent = centers.hi[axis] - lo;
+  int mid = (begin + end) / 2;
+  auto center_less = [this, axis](int i, int j) {
+    return boxes[i].lo[axis] + boxes[i].hi[axis] < boxes[j].lo[axis] + boxes[j].hi[axis];
+  };
+  if (extent > 0) {
+    auto bin_of = [this, axis, lo, extent](int i) {
+      int bin = ((boxes[i].lo[axis] + boxes[i].hi[axis]) / 2 - lo) / extent * BVH_BINS;
+      return min(bin, BVH_BINS - 1);
+    };
+    Box bin_box[BVH_BINS];
+    int bin_count[BVH_BINS] = {};
+    for (int i = begin; i < end; ++i) {
+      int bin = bin_of(ids[i]);
+      bin_box[bin].Add(boxes[ids[i]]);
+      ++bin_count[bin];
+    }
+    double right_cost[BVH_BINS] = {}; // стоимость правой части из корзин b..BVH_BINS - 1
+    Box right;
+    int right_count = 0;
+    for (int bin = BVH_BINS - 1; bin > 0; --bin) {
+      right.Add(bin_box[bin]);
+      right_count += bin_count[bin];
+      right_cost[bin] = right.Area() * right_count;
+    }
+    Box left;
+    int left_count = 0;
+    double best_cost = std::numeric_limits<double>::infinity();
+    int best_bin = 0;
+    for (int bin = 1; bin < BVH_BINS; ++bin) { // левая часть - корзины 0..bin - 1
+      left.Add(bin_box[bin - 1]);
+      left_count += bin_count[bin - 1];
+      double cost = left.Area() * left_count + right_cost[bin];
+      if (left_count > 0 && left_count < end - begin && cost < best_cost) {
+        best_cost = cost;
+        best_bin = bin;
+      }
+    }
+    if (best_bin > 0) {
+      mid = std::partition(ids.begin() + begin, ids.begin() + end, [&bin_of, best_bin](int i) {
+        return bin_of(i) < best_bin;
+      }) - ids.begin();
+    } else {
+      std::nth_element(ids.begin() + begin, ids.begin() + mid, ids.begin() + end, center_less);
+    }
+  } else { // все центры совпали, делим пополам
+    std::nth_element(ids.begin() + begin, ids.begin() + mid, ids.begin() + end, center_less);
+  }
+  int left_node = nodes.size();
+  nodes.push_back(Node());
+  nodes.push_back(Node());
+  nodes[node].first = left_node;
+  nodes[node].count = 0;
+  Split(left_node, begin, mid);
+  Split(left_node + 1, mid, end);
+}
+
+int SegmentBVH::Size() const {
+  return segs.size();
+}
+
+void SegmentBVH::Search(const Segment& query, const Box& query_box, int skip, size_t k, double bound, vector<pair<double, int>>& best) const {
+  auto heap_less = [](const pair<double, int>& lhs, const pair<double, int>& rhs) {
+    return lhs.first < rhs.first;
+  };
+  vector<pair<double, int>> stack; // (квадрат нижней оценки, узел)
+  stack.push_back({BoxGap(nodes[0].box, query_box), 0});
+  while (!stack.empty()) {
+    double gap = stack.back().first;
+    const Node& node = nodes[stack.back().second];
+    stack.pop_back();
+    double limit = best.size() == k ? best.front().first : bound;
+    if (gap >= limit * limit) {
+      continue;
+    }
+    if (node.count) {
+      for (int i = node.first; i < node.first + node.count; ++i) {
+        limit = best.size() == k ? best.front().first : bound;
+        if (i == skip || BoxGap(boxes[i], query_box) >= limit * limit) {
+          continue;
+        }
+        double dist = SegmentDistance(query, segs[i]); // точная проверка в листе
+        if (dist < limit) {
+          if (best.size() == k) {
+            std::pop_heap(best.begin(), best.end(), heap_less);
+            best.pop_back();
+          }
+          best.push_back({dist, i});
+          std::push_heap(best.begin(), best.end(), heap_less);
+        }
+      }
+      continue;
+    }
+    double left_gap = BoxGap(nodes[node.first].box, query_box);
+    double right_gap = BoxGap(nodes[node.first + 1].box, query_box);
+    if (left_gap < right_gap) { // ближний потомок снимается со стека первым
+      stack.push_back({right_gap, node.first + 1});
+      stack.push_back({left_gap, node.first});
+    } else {
+      stack.push_back({left_gap, node.first});
+      stack.push_back({right_gap, node.first + 1});
+    }
+  }
 }
 
-Vector operator*(Vector vec, double mod) {
-  vec *= mod;
-  return vec;
+bool SegmentBVH::ClosestPair(int& first, int& second, double& dist) const {
+  if (segs.size() < 2) {
+    return false;
+  }
+  dist = std::numeric_limits<double>::infinity();
+  vector<pair<double, int>> best;
+  for (size_t i = 0; i < segs.size(); ++i) { // ближайший сосед каждого отрезка, отсечение по лучшей паре
+    best.clear();
+    Search(segs[i], boxes[i], i, 1, dist, best);
+    if (!best.empty()) {
+      dist = best[0].first;
+      first = ids[i];
+      second = ids[best[0].second];
+    }
+  }
+  if (first > second) {
+    std::swap(first, second);
+  }
+  return true;
 }
 
-Vector operator*(double mod, const Vector& vec) {
-  return vec * mod;
+vector<pair<double, int>> SegmentBVH::Nearest(const Segment& query, int k) const {
+  vector<pair<double, int>> best;
+  if (k <= 0 || segs.empty()) {
+    return best;
+  }
+  Search(query, Box(query), -1, k, std::numeric_limits<double>::infinity(), best);
+  std::sort(best.begin(), best.end());
+  for (pair<double, int>& item : best) {
+    item.second = ids[item.second];
+  }
+  return best;
 }
 
-Vector& Vector::operator+=(const Vector& other) {
-  x += other.x;
-  y += other.y;
-  z += other.z;
-  return *this;
+vector<pair<double, int>> SegmentBVH::Nearest(const Point& query, int k) const {
+  return Nearest(Segment(query, query), k);
 }
 
-Vector operator+(Vector lhs, const Vector& rhs) {
-  lhs += rhs;
-  return lhs;
-}
+Segment::Segment(const Point& begin, const Point& end) :
+    begin(begin),
+    end(end) {
 
-Vector& Vector::operator-=(const Vector& other) {
-  x -= other.x;
-  y -= other.y;
-  z -= other.z;
-  return *this;
 }
 
-Vector operator-(Vector lhs, const Vector& rhs) {
-  lhs -= rhs;
-  return lhs;
+const Point& Segment::GetBegin() const {
+  return begin;
 }
 
-istream& operator>>(istream& in, Vector& vec) {
-  in >> vec.x >> vec.y >> vec.z;
-  return in;
+const Point& Segment::GetEnd() const {
+  return end;
 }
 
-ostream& operator<<(ostream& out, const Vector& vec) {
-  out << vec.x << " " << vec.y << " " << vec.z;
-  return out;
+double Segment::GetLength() const {
+  return Vector(begin, end).GetLength();
 }
@@ -4,68 +4,37 @@
 #include <math.h>
 #include <stack>
 #include <cstdint>
+#include <random>
+#include <string>
+#include <unordered_set>
+#include <thread>
+#include <atomic>
+#include <charconv>
+#include "../geometry.h"
+#include "../predicates.h"
+#include "../pointio.h"
 
 using std::cin;
 using std::cout;
 using std::endl;
-using std::istream;
-using std::ostream;
 using std::vector;
 using std::swap;
+using std::string;
 
 static const double EPS = std::numeric_limits<double>::epsilon();
+static const int MIN_HULL_CHUNK = 1 << 12; // Меньшие куски не стоят отдельной задачи
+static const double CONTAINS_EPS = 1e-9; // Относительный допуск на границе оболочки
+static const int LOCATE_SAMPLES = 32; // Случайные грани, из которых выбирается старт поиска видимой
+static const int CHUNKS_PER_THREAD = 4; // Запас задач, чтобы освободившиеся потоки забирали чужую работу
+static const int MAX_REMOVED_DEGREE = 8; // Степень удаляемых на уровне иерархии вершин, от неё зависит константа запросов
+static const double CERTIFICATE_EPS = 1e-12; // Определитель единичных нормалей, ниже которого они считаются компланарными
 
-typedef std::pair<int16_t, int16_t> pair;
-
-class Vector;
-
-class Point {
-  public:
-    Point();
-    Point(double x, double y, double z);
-    double GetX() const;
-    double GetY() const;
-    double GetZ() const;
-    Point& operator+=(const Vector& vec);
-    friend Point operator+(Point point, const Vector& vec);
-    friend istream& operator>>(istream& in, Point& point);
-    friend ostream& operator<<(ostream& out, const Point& point);
-    friend bool ComparePoints(const Point& lhs, const Point& rhs);
-  private:
-    double x;
-    double y;
-    double z;
-};
+typedef std::pair<int32_t, int32_t> pair;
+typedef BasicPoint<double, 3> Point;
+typedef BasicVector<double, 3> Vector;
 
 bool ComparePoints(const Point& lhs, const Point& rhs);
 
-class Vector {
-  public:
-    Vector();
-    Vector(double x, double y, double z);
-    Vector(const Point& begin, const Point& end);
-    explicit Vector(const Point& point);
-    double GetX() const;
-    double GetY() const;
-    double GetZ() const;
-    double GetLength() const;
-    Vector& operator*=(double mod);
-    friend double DotProduct(const Vector& lhs, const Vector& rhs);
-    friend Vector CrossProduct(const Vector& lhs, const Vector& rhs);
-    friend Vector operator*(Vector vec, double mod);
-    friend Vector operator*(double mod, const Vector& vec);
-    Vector& operator+=(const Vector& other);
-    friend Vector operator+(Vector lhs, const Vector& rhs);
-    Vector& operator-=(const Vector& other);
-    friend Vector operator-(Vector lhs, const Vector& rhs);
-    friend istream& operator>>(istream& in, Vector& vec);
-    friend ostream& operator<<(ostream& out, const Vector& vec);
-  private:
-    double x;
-    double y;
-    double z;
-};
-
 class Plane {
   public:
     Plane(const Point& first_point, const Point& second_point, const Point& third_point);
@@ -80,40 +49,167 @@ class Plane {
 struct Face {
   Face(int a, int b, int c);
   void Fix(const vector<Point>& pts); // Находит правильный порядок для грани
-  bool operator==(const Face& other);
-  int16_t a;
-  int16_t b;
-  int16_t c;
+  void Rotate(); // Циклический сдвиг, первой становится минимальная вершина, ориентация сохраняется
+  bool operator==(const Face& other) const;
+  int32_t a;
+  int32_t b;
+  int32_t c;
+};
+
+struct FaceHash {
+  size_t operator()(const Face& face) const;
 };
 
 struct FaceCompare {
   bool operator()(const Face& lhs, const Face& rhs);
 };
 
+class EdgeSet { // Множество ориентированных рёбер с открытой адресацией, 8 байт на ячейку
+  public:
+    EdgeSet();
+    bool Contains(int from, int to) const;
+    void Insert(int from, int to);
+  private:
+    static uint64_t Key(int from, int to);
+    size_t Slot(uint64_t key) const; // Ячейка с ключом или первая пустая после неё
+    void Grow();
+
+    static constexpr uint64_t EMPTY_KEY = ~0ull;
+    vector<uint64_t> table;
+    int bits;
+    size_t size;
+};
+
+class IncrementalHull { // Рандомизированный инкрементальный алгоритм с графом конфликтов, O(N log N) в среднем
+  public:
+    IncrementalHull();
+    IncrementalHull(const vector<Point>& points);
+    void Build(const vector<Point>& points); // Буферы прошлых построений переиспользуются
+    void Insert(const Point& point);
+    void InsertBatch(const vector<Point>& points); // Меняются только видимые грани, пачка вставляется в случайном порядке
+    vector<Face> GetFaces() const; // Снимок текущих граней в том же виде, что и у BuildConvexHull
+    vector<int> GetVertices() const; // Вершины оболочки, для плоского набора - все точки
+  private:
+    struct HullFace {
+      int v[3]; // Против часовой, если смотреть снаружи
+      int adj[3]; // adj[i] - соседняя грань через ребро v[i] -> v[(i + 1) % 3]
+      vector<int> conflicts; // Ещё не добавленные точки, которые видят грань
+      Vector dual; // Грань в двойственном пространстве относительно center, для поиска видимой грани
+      bool alive;
+    };
+    bool Start(); // Начальный тетраэдр, false, если все точки в одной плоскости
+    int AddFace(int a, int b, int c);
+    bool Sees(int point, int face) const;
+    void InsertPending(int point); // Заменяет видимые из точки грани конусом из горизонта
+    void Locate(int point); // Заносит новую точку в конфликты видимых из неё граней
+    void Relink(int face, int from, int to, int other); // Сосед face через ребро from -> to теперь other
+
+    vector<Point> pts;
+    vector<HullFace> faces;
+    vector<vector<int>> point_faces; // Грани, которые видит точка, мёртвые удаляются лениво
+    vector<int> order; // Порядок вставки
+    vector<int> visible; // Видимые из вставляемой точки грани
+    vector<int> face_mark; // Отметки видимых граней
+    vector<int> climb_mark; // Отметки граней, пройденных при подъёме
+    vector<int> point_mark; // Отметки точек при пересчёте конфликтов
+    vector<int> hor_next; // Горизонт: ребро u -> hor_next[u]
+    vector<int> hor_out; // Невидимая грань за ребром горизонта
+    vector<int> hor_in; // Видимая грань перед ребром горизонта
+    vector<bool> inserted;
+    Point center; // Внутренняя точка начального тетраэдра
+    int hint; // Живая грань, с которой начинается поиск видимой
+    std::mt19937 generator; // Для выбора случайных граней
+    bool flat;
+};
+
+class HullMesh { // Полурёберная структура оболочки, полурёбра грани f - 3f, 3f + 1, 3f + 2
+  public:
+    HullMesh(const vector<Point>& points, const vector<Face>& faces);
+    int FacesNumber() const;
+    int Origin(int edge) const;
+    int Twin(int edge) const;
+    int Neighbour(int face, int i) const; // Соседняя грань через i-е ребро
+    int ExtremePoint(const Vector& dir) const; // Спуск по иерархии Добкина-Киркпатрика, O(log n); -1 без граней
+    bool Contains(const Point& point) const; // Спуск по той же иерархии, O(log n), на границе - внутри
+  private:
+    struct Level { // Уровень иерархии: оболочка без независимого набора вершин малой степени
+      vector<int> corners; // Вершины граней тройками, против часовой снаружи
+      vector<int> owner; // Удалённая вершина, дыру от которой закрывает грань, -1 - грань есть и уровнем ниже
+      vector<int> down_begin; // Грани уровня ниже под гранью: down[down_begin[f]] .. down[down_begin[f + 1] - 1]
+      vector<int> down;
+    };
+    static int Next(int edge);
+    bool Sees(const Point& point, int face) const; // Точка строго снаружи плоскости грани, точный предикат
+    bool PinTetrahedron(int pinned[4]); // Четыре вершины не в одной плоскости, center - их центр строго внутри
+    static void CollectStars(const vector<int>& corners, vector<int>& local, vector<int>& vertices,
+                             vector<int>& star_begin, vector<int>& star); // Грани вокруг каждой вершины, local - рабочий массив из -1
+    void BuildHierarchy();
+    bool CloseHole(const int* ring, int size, vector<int>& caps) const; // Отсечение ушей, каждая новая грань - грань выпуклой оболочки соседей
+    bool InCone(const Level& level, int face, const Point& point) const; // Луч из center в точку проходит через замкнутую грань
+    Vector UnitNormal(const Level& level, int face) const;
+    int Certificate(const Level& level, const int* pool, int size, const Vector& dir, int* cert) const; // До трёх граней у вершины, в конус нормалей которых входит dir
+    int BruteExtreme(const Vector& dir) const; // Перебор для плоской оболочки
+
+    vector<Point> pts;
+    vector<int> origin;
+    vector<int> twin;
+    vector<Level> levels; // levels[0] - сама оболочка, пусто для плоской оболочки
+    Point center; // Внутри всех уровней: закреплённый тетраэдр не удаляется
+    vector<int> top_vertices; // Вершины и звёзды граней верхнего уровня
+    vector<int> top_star_begin;
+    vector<int> top_star;
+};
+
 int Turn(int first_p, int second_p, const vector<Point>& pts, int pts_num); // Выполняет поворот вокруг ребра, вычисляя третью точку
 double Volume(int p1, int p2, int p3, int p4, const vector<Point>& pts); // Находит ориентированный объем тетраэдра
 double Area(int p1, int p2, int p3, const vector<Point>& pts); // Находит площадь треугольника
+bool Collinear(int p1, int p2, int p3, const vector<Point>& pts); // Точно: вырождены все три координатные проекции
 vector<Face> BuildConvexHull(vector<Point> pts);
+vector<Face> ParallelConvexHull(const vector<Point>& pts, int threads = 0); // 0 - все аппаратные потоки
+vector<vector<Face>> BuildConvexHulls(const vector<vector<Point>>& tests, int threads = 0); // Независимые тесты параллельно
+void WriteHull(const vector<Face>& hull, string& out); // Текстовый вывод в буфер без сброса на каждой строке
 
-int main() { // РЕШЕНИЕ ЗА O(N^2)
-  int tests_num;
-  cin >> tests_num;
-  vector<Point> pts;
-  int size;
-  FaceCompare comp;
-  for (int i = 0; i < tests_num; ++i) {
-    cin >> size;
-    pts.resize(size);
-    for (int j = 0; j < size; ++j) {
-      cin >> pts[j];
+int main(int argc, char** argv) { // O(N log N) в среднем, --gift-wrapping - старое решение за O(N^2), --f64/--f32 - бинарный ввод
+  bool gift_wrapping = std::find(argv + 1, argv + argc, string("--gift-wrapping")) != argv + argc;
+  InputReader reader(FormatFromArgs(argc, argv));
+  int64_t tests_num = 0;
+  if (!reader.ReadCount(tests_num) || tests_num < 0) {
+    std::cerr << "bad input\n";
+    return 1;
+  }
+  vector<vector<Point>> tests(tests_num);
+  int64_t size = 0;
+  vector<double> coords;
+  for (vector<Point>& pts : tests) {
+    if (!reader.ReadCount(size) || size < 0) {
+      std::cerr << "bad input\n";
+      return 1;
     }
-    vector<Face> result = BuildConvexHull(std::move(pts));
-    sort(result.begin(), result.end(), comp);
-    cout << result.size() << endl;
-    for (const Face& face : result) {
-      cout << "3 " << face.a << " " << face.b << " " << face.c << std::endl;
+    coords.resize(3 * size);
+    if (!reader.ReadCoords(coords.data(), coords.size())) { // оборванный вход не считается нулями
+      std::cerr << "bad input\n";
+      return 1;
+    }
+    pts.reserve(size);
+    for (int64_t j = 0; j < size; ++j) {
+      pts.emplace_back(coords[3 * j], coords[3 * j + 1], coords[3 * j + 2]);
+    }
+  }
+  vector<vector<Face>> results;
+  if (gift_wrapping) {
+    for (const vector<Point>& pts : tests) {
+      results.push_back(BuildConvexHull(pts));
     }
+  } else {
+    results = BuildConvexHulls(tests);
   }
+  FaceCompare comp;
+  string out;
+  for (vector<Face>& result : results) {
+    sort(result.begin(), result.end(), comp);
+    WriteHull(result, out);
+  }
+  cout.write(out.data(), out.size());
   return 0;
 }
 
@@ -121,6 +217,18 @@ double Area(int p1, int p2, int p3, const vector<Point>& pts) {
   return fabs(CrossProduct(Vector(pts[p1], pts[p2]), Vector(pts[p2], pts[p3])).GetLength() / 2);
 }
 
+bool Collinear(int p1, int p2, int p3, const vector<Point>& pts) {
+  for (int axis = 0; axis < 3; ++axis) {
+    int u = (axis + 1) % 3;
+    int v = (axis + 2) % 3;
+    if (Orient2d(pts[p1].GetCoord(u), pts[p1].GetCoord(v), pts[p2].GetCoord(u), pts[p2].GetCoord(v),
+                 pts[p3].GetCoord(u), pts[p3].GetCoord(v)) != 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
 double Volume(int p1, int p2, int p3, int p4, const vector<Point>& pts) {
   return DotProduct(Vector(pts[p1], pts[p4]), CrossProduct(Vector(pts[p1], pts[p2]), Vector(pts[p1], pts[p3])));
 }
@@ -128,13 +236,13 @@ double Volume(int p1, int p2, int p3, int p4, const vector<Point>& pts) {
 int Turn(int first_p, int second_p, const vector<Point>& pts, int pts_num) {
   int third_p = 0;
   double max_ar = Area(first_p, second_p, 0, pts);
-  double vol;
+  int orient;
   double ar;
   for (int i = 1; i < pts_num; ++i) {
-    vol = Volume(first_p, second_p, third_p, i, pts);
-    if (vol < -EPS) {
+    orient = Orient3d(pts[first_p], pts[second_p], pts[third_p], pts[i]); // Точный знак объёма
+    if (orient < 0) {
       third_p = i;
-    } else if (fabs(vol) < EPS) {
+    } else if (orient == 0) {
       ar = Area(first_p, second_p, i, pts);
       if (ar > max_ar) {
         ar = max_ar;
@@ -170,7 +278,8 @@ void Face::Fix(const vector<Point>& pts) {
 vector<Face> BuildConvexHull(vector<Point> pts) {
   int pts_num = pts.size();
   vector<Face> hull;
-  vector<vector<int16_t>> processed(pts_num, vector<int16_t>(pts_num));
+  std::unordered_set<Face, FaceHash> found; // Уже найденные грани
+  EdgeSet processed;
   int first_point = std::min_element(pts.begin(), pts.end(), ComparePoints) - pts.begin();
   int second_point = first_point; // Поиск начального ребра
   for (int i = 0; i < pts_num; ++i) {
@@ -190,30 +299,32 @@ vector<Face> BuildConvexHull(vector<Point> pts) {
   Face lowest(first_point, second_point, third_point);
   lowest.Fix(pts);
   hull.push_back(lowest);
+  found.insert(lowest);
   edges.emplace(second_point, first_point);
   edges.emplace(third_point, second_point);
   edges.emplace(first_point, third_point);
   while (!edges.empty()) {
     pair top = edges.top();
     edges.pop();
-    if (!processed[top.first][top.second]) {
+    if (!processed.Contains(top.first, top.second)) {
       third_point = Turn(top.first, top.second, pts, pts_num);
       if (first_point != second_point && first_point != third_point && second_point != third_point) {
         Face result(top.first, top.second, third_point);
         result.Fix(pts);
-        if (std::find(hull.begin(), hull.end(), result) == hull.end()) {
+        if (found.insert(result).second) {
           hull.push_back(result);
         }
-        if (!processed[top.second][top.first]) {
+        if (!processed.Contains(top.second, top.first)) {
           edges.emplace(top.second, top.first);
         }
-        if (!processed[third_point][top.second]) {
+        if (!processed.Contains(third_point, top.second)) {
           edges.emplace(third_point, top.second);
         }
-        if (!processed[top.first][third_point]) {
+        if (!processed.Contains(top.first, third_point)) {
           edges.emplace(top.first, third_point);
         }
-        processed[top.first][top.second] = processed[top.second][top.first] = true;
+        processed.Insert(top.first, top.second);
+        processed.Insert(top.second, top.first);
       }
 
     }
@@ -221,186 +332,887 @@ vector<Face> BuildConvexHull(vector<Point> pts) {
   return hull;
 }
 
-bool FaceCompare::operator()(const Face& lhs, const Face& rhs) {
-  return (lhs.a < rhs.a ||
-         (lhs.a == rhs.a && lhs.b < rhs.b) ||
-         (lhs.a == rhs.a && lhs.b == rhs.b && lhs.c < rhs.c));
+EdgeSet::EdgeSet() :
+    table(16, EMPTY_KEY),
+    bits(4),
+    size(0) {
+
 }
 
-bool ComparePoints(const Point& lhs, const Point& rhs) {
-  return (lhs.z < rhs.z - EPS ||
-         (fabs(lhs.z - rhs.z) < EPS && lhs.x < rhs.x - EPS) ||
-         (fabs(lhs.z - rhs.z) < EPS && fabs(lhs.x - rhs.x) < EPS && lhs.y < rhs.y - EPS));
+uint64_t EdgeSet::Key(int from, int to) {
+  return (static_cast<uint64_t>(static_cast<uint32_t>(from)) << 32) | static_cast<uint32_t>(to);
 }
 
-Plane::Plane(const Point& first_point, const Point& second_point, const Point& third_point) {
-  Vector norm = CrossProduct(Vector(first_point, second_point), Vector(first_point, third_point));
-  a = norm.GetX();
-  b = norm.GetY();
-  c = norm.GetZ();
-  d = -a * first_point.GetX() - b * first_point.GetY() - c * first_point.GetZ();
+size_t EdgeSet::Slot(uint64_t key) const {
+  size_t mask = table.size() - 1;
+  size_t slot = (key * 0x9E3779B97F4A7C15ull) >> (64 - bits); // Фибоначчиево хеширование
+  while (table[slot] != EMPTY_KEY && table[slot] != key) {
+    slot = (slot + 1) & mask;
+  }
+  return slot;
 }
 
-Vector Plane::NormVector() {
-  return Vector(a, b, c);
+bool EdgeSet::Contains(int from, int to) const {
+  uint64_t key = Key(from, to);
+  return table[Slot(key)] == key;
 }
 
-double DotProduct(const Vector& lhs, const Vector& rhs) {
-  return lhs.x * rhs.x + lhs.y * rhs.y + lhs.z * rhs.z;
+void EdgeSet::Insert(int from, int to) {
+  uint64_t key = Key(from, to);
+  size_t slot = Slot(key);
+  if (table[slot] == key) {
+    return;
+  }
+  table[slot] = key;
+  if (++size * 2 > table.size()) { // Заполненность не больше половины
+    Grow();
+  }
 }
 
-Vector CrossProduct(const Vector& lhs, const Vector& rhs) {
-  return Vector(lhs.y * rhs.z - lhs.z * rhs.y,
-                lhs.z * rhs.x - lhs.x * rhs.z,
-                lhs.x * rhs.y - lhs.y * rhs.x);
+void EdgeSet::Grow() {
+  vector<uint64_t> old(table.size() * 2, EMPTY_KEY);
+  table.swap(old);
+  ++bits;
+  for (uint64_t key : old) {
+    if (key != EMPTY_KEY) {
+      table[Slot(key)] = key;
+    }
+  }
 }
 
-Face::Face(int a, int b, int c) :
-    a(a),
-    b(b),
-    c(c) {
+IncrementalHull::IncrementalHull() :
+    flat(true) {
 
 }
 
-Point::Point() :
-    x(0),
-    y(0),
-    z(0) {
+IncrementalHull::IncrementalHull(const vector<Point>& points) {
+  Build(points);
+}
 
+void IncrementalHull::Build(const vector<Point>& points) {
+  pts = points;
+  faces.clear();
+  face_mark.clear();
+  climb_mark.clear();
+  point_faces.resize(pts.size());
+  for (vector<int>& seen : point_faces) {
+    seen.clear();
+  }
+  point_mark.assign(pts.size(), -1);
+  hor_next.resize(pts.size());
+  hor_out.resize(pts.size());
+  hor_in.resize(pts.size());
+  inserted.assign(pts.size(), false);
+  flat = !Start();
+  if (flat) {
+    return;
+  }
+  order.clear();
+  for (int i = 0; i < static_cast<int>(pts.size()); ++i) {
+    if (!inserted[i]) {
+      order.push_back(i);
+    }
+  }
+  std::shuffle(order.begin(), order.end(), std::mt19937(pts.size())); // Случайный порядок даёт O(N log N) в среднем
+  for (int point : order) {
+    InsertPending(point);
+  }
+}
+
+void IncrementalHull::Insert(const Point& point) {
+  InsertBatch(vector<Point>(1, point));
+}
+
+void IncrementalHull::InsertBatch(const vector<Point>& points) {
+  if (flat) { // Тетраэдра ещё нет, строим заново по всем точкам
+    vector<Point> all = pts;
+    all.insert(all.end(), points.begin(), points.end());
+    Build(all);
+    return;
+  }
+  int first = pts.size();
+  pts.insert(pts.end(), points.begin(), points.end());
+  point_faces.resize(pts.size());
+  point_mark.resize(pts.size(), -1);
+  hor_next.resize(pts.size());
+  hor_out.resize(pts.size());
+  hor_in.resize(pts.size());
+  inserted.resize(pts.size(), false);
+  order.clear();
+  for (int i = first; i < static_cast<int>(pts.size()); ++i) {
+    Locate(i);
+    order.push_back(i);
+  }
+  std::shuffle(order.begin(), order.end(), std::mt19937(pts.size()));
+  for (int point : order) {
+    InsertPending(point);
+  }
+}
+
+void IncrementalHull::Locate(int point) {
+  Vector dir(center, pts[point]);
+  int best = hint;
+  double best_val = DotProduct(faces[best].dual, dir);
+  for (int i = 0; i < LOCATE_SAMPLES; ++i) { // Старт с лучшей из случайных граней укорачивает подъём
+    int face = generator() % faces.size();
+    double val = DotProduct(faces[face].dual, dir);
+    if (faces[face].alive && val > best_val) {
+      best_val = val;
+      best = face;
+    }
+  }
+  vector<int> stack(1, best); // Подъём к грани, плоскость которой точка нарушает сильнее всего
+  climb_mark[best] = point;
+  while (!stack.empty()) { // Площадки из компланарных граней обходятся целиком
+    int face = stack.back();
+    stack.pop_back();
+    for (int i = 0; i < 3; ++i) {
+      int other = faces[face].adj[i];
+      double val = DotProduct(faces[other].dual, dir);
+      double tolerance = CONTAINS_EPS * fabs(best_val);
+      if (climb_mark[other] == point || val < best_val - tolerance) {
+        continue;
+      }
+      climb_mark[other] = point;
+      if (val > best_val + tolerance) { // Подъём продолжается от лучшей грани
+        stack.clear();
+        best_val = val;
+        best = other;
+      }
+      stack.push_back(other);
+      if (best == other) {
+        break;
+      }
+    }
+  }
+  int start = Sees(point, best) ? best : -1;
+  for (int f = 0; start == -1 && best_val > 1 - CONTAINS_EPS && f < static_cast<int>(faces.size()); ++f) {
+    if (faces[f].alive && Sees(point, f)) { // У самой границы подъём в double мог ошибиться, решает точный предикат
+      start = f;
+    }
+  }
+  if (start == -1) { // Точка внутри оболочки
+    return;
+  }
+  stack.assign(1, start); // Видимые грани связны, обход в глубину от найденной
+  face_mark[start] = point;
+  while (!stack.empty()) {
+    int face = stack.back();
+    stack.pop_back();
+    faces[face].conflicts.push_back(point);
+    point_faces[point].push_back(face);
+    for (int i = 0; i < 3; ++i) {
+      int other = faces[face].adj[i];
+      if (face_mark[other] != point && face_mark[other] != -2 - point) { // -2 - point - проверена и не видна
+        face_mark[other] = Sees(point, other) ? point : -2 - point;
+        if (face_mark[other] == point) {
+          stack.push_back(other);
+        }
+      }
+    }
+  }
+}
+
+bool IncrementalHull::Start() {
+  int pts_num = pts.size();
+  int first = 0;
+  int second = 1;
+  while (second < pts_num && pts[first] == pts[second]) { // Без допусков, чтобы масштаб координат не влиял на выбор
+    ++second;
+  }
+  int third = second + 1;
+  while (third < pts_num && Collinear(first, second, third, pts)) {
+    ++third;
+  }
+  int fourth = third + 1;
+  while (fourth < pts_num && Orient3d(pts[first], pts[second], pts[third], pts[fourth]) == 0) {
+    ++fourth;
+  }
+  if (fourth >= pts_num) {
+    return false;
+  }
+  if (Orient3d(pts[first], pts[second], pts[third], pts[fourth]) > 0) { // Четвёртая точка должна быть внутри, то есть не видеть грань
+    swap(second, third);
+  }
+  Vector sum = Vector(pts[first]) + Vector(pts[second]) + Vector(pts[third]) + Vector(pts[fourth]);
+  center = Point(sum.GetX() / 4, sum.GetY() / 4, sum.GetZ() / 4);
+  hint = 0;
+  AddFace(first, second, third);
+  AddFace(first, fourth, second);
+  AddFace(second, fourth, third);
+  AddFace(third, fourth, first);
+  for (int f = 0; f < 4; ++f) { // Соседи тетраэдра находятся перебором
+    for (int i = 0; i < 3; ++i) {
+      for (int g = 0; g < 4; ++g) {
+        for (int j = 0; j < 3; ++j) {
+          if (faces[f].v[i] == faces[g].v[(j + 1) % 3] && faces[f].v[(i + 1) % 3] == faces[g].v[j]) {
+            faces[f].adj[i] = g;
+          }
+        }
+      }
+    }
+  }
+  inserted[first] = inserted[second] = inserted[third] = inserted[fourth] = true;
+  for (int i = 0; i < pts_num; ++i) {
+    for (int f = 0; f < 4 && !inserted[i]; ++f) {
+      if (Sees(i, f)) {
+        faces[f].conflicts.push_back(i);
+        point_faces[i].push_back(f);
+      }
+    }
+  }
+  return true;
+}
+
+int IncrementalHull::AddFace(int a, int b, int c) {
+  Vector norm = CrossProduct(Vector(pts[a], pts[b]), Vector(pts[a], pts[c]));
+  Vector dual = norm * (1 / DotProduct(norm, Vector(center, pts[a])));
+  faces.push_back(HullFace{{a, b, c}, {-1, -1, -1}, vector<int>(), dual, true});
+  face_mark.push_back(-1);
+  climb_mark.push_back(-1);
+  return faces.size() - 1;
 }
 
-Point::Point(double x, double y, double z) :
-    x(x),
-    y(y),
-    z(z) {
+bool IncrementalHull::Sees(int point, int face) const {
+  return Orient3d(pts[faces[face].v[0]], pts[faces[face].v[1]], pts[faces[face].v[2]], pts[point]) > 0;
+}
 
+void IncrementalHull::Relink(int face, int from, int to, int other) {
+  for (int i = 0; i < 3; ++i) {
+    if (faces[face].v[i] == from && faces[face].v[(i + 1) % 3] == to) {
+      faces[face].adj[i] = other;
+    }
+  }
+}
+
+void IncrementalHull::InsertPending(int point) {
+  inserted[point] = true;
+  visible.clear();
+  for (int face : point_faces[point]) {
+    if (faces[face].alive) {
+      visible.push_back(face);
+      face_mark[face] = point;
+    }
+  }
+  point_faces[point].clear();
+  if (visible.empty()) { // Точка внутри оболочки
+    return;
+  }
+  int start = -1;
+  for (int face : visible) { // Рёбра видимых граней, за которыми невидимая грань, образуют горизонт
+    for (int i = 0; i < 3; ++i) {
+      int other = faces[face].adj[i];
+      if (face_mark[other] != point) {
+        start = faces[face].v[i];
+        hor_next[start] = faces[face].v[(i + 1) % 3];
+        hor_out[start] = other;
+        hor_in[start] = face;
+      }
+    }
+  }
+  int first_new = faces.size();
+  int vertex = start;
+  do { // Обход горизонта по циклу, новые грани идут подряд
+    int created = AddFace(vertex, hor_next[vertex], point);
+    Relink(hor_out[vertex], hor_next[vertex], vertex, created);
+    faces[created].adj[0] = hor_out[vertex];
+    vertex = hor_next[vertex];
+  } while (vertex != start);
+  int new_num = faces.size() - first_new;
+  for (int j = 0; j < new_num; ++j) {
+    int created = first_new + j;
+    faces[created].adj[1] = first_new + (j + 1) % new_num;
+    faces[created].adj[2] = first_new + (j + new_num - 1) % new_num;
+    int from = faces[created].v[0];
+    for (int source : {hor_in[from], hor_out[from]}) { // Новую грань могут видеть только точки двух граней у ребра
+      for (int other : faces[source].conflicts) {
+        if (!inserted[other] && point_mark[other] != created && Sees(other, created)) {
+          point_mark[other] = created;
+          faces[created].conflicts.push_back(other);
+          point_faces[other].push_back(created);
+        }
+      }
+    }
+  }
+  for (int face : visible) {
+    faces[face].alive = false;
+    faces[face].conflicts = vector<int>();
+  }
+  hint = first_new;
 }
 
-double Point::GetX() const {
-  return x;
+vector<Face> IncrementalHull::GetFaces() const {
+  vector<Face> hull;
+  if (flat) {
+    return hull;
+  }
+  for (const HullFace& face : faces) {
+    if (face.alive) {
+      hull.emplace_back(face.v[0], face.v[1], face.v[2]);
+      hull.back().Rotate();
+    }
+  }
+  return hull;
 }
 
-double Point::GetY() const {
-  return y;
+vector<int> IncrementalHull::GetVertices() const {
+  vector<int> vertices;
+  vector<bool> taken(pts.size(), flat);
+  for (const HullFace& face : faces) {
+    for (int i = 0; i < 3 && face.alive; ++i) {
+      taken[face.v[i]] = true;
+    }
+  }
+  for (int i = 0; i < static_cast<int>(pts.size()); ++i) {
+    if (taken[i]) {
+      vertices.push_back(i);
+    }
+  }
+  return vertices;
 }
 
-double Point::GetZ() const {
-  return z;
+vector<vector<Face>> BuildConvexHulls(const vector<vector<Point>>& tests, int threads) {
+  int tests_num = tests.size();
+  if (tests_num == 1) { // Один большой тест распараллеливается внутри
+    return {ParallelConvexHull(tests[0], threads)};
+  }
+  vector<vector<Face>> results(tests_num);
+  int hardware = std::thread::hardware_concurrency();
+  int workers = std::max(1, std::min(threads ? threads : hardware, tests_num));
+  std::atomic<int> next_test(0);
+  vector<std::thread> pool;
+  for (int w = 0; w < workers; ++w) {
+    pool.emplace_back([&]() {
+      IncrementalHull workspace; // Один на поток, память не выделяется заново на каждый тест
+      for (int test = next_test++; test < tests_num; test = next_test++) {
+        workspace.Build(tests[test]);
+        results[test] = workspace.GetFaces();
+      }
+    });
+  }
+  for (std::thread& thr : pool) {
+    thr.join();
+  }
+  return results;
 }
 
-istream& operator>>(istream& in, Point& point) {
-  in >> point.x >> point.y >> point.z;
-  return in;
+void WriteHull(const vector<Face>& hull, string& out) {
+  char buf[16];
+  out.append(buf, std::to_chars(buf, buf + sizeof(buf), hull.size()).ptr);
+  out += '\n';
+  for (const Face& face : hull) {
+    out += '3';
+    for (int vertex : {face.a, face.b, face.c}) {
+      out += ' ';
+      out.append(buf, std::to_chars(buf, buf + sizeof(buf), vertex).ptr);
+    }
+    out += '\n';
+  }
 }
 
-ostream& operator<<(ostream& out, const Point& point) {
-  out << point.x << " " << point.y << " " << point.z;
-  return out;
+vector<Face> ParallelConvexHull(const vector<Point>& pts, int threads) {
+  int pts_num = pts.size();
+  int hardware = std::thread::hardware_concurrency();
+  int workers = std::max(1, std::min(threads ? threads : hardware, pts_num / MIN_HULL_CHUNK));
+  if (workers == 1) {
+    return IncrementalHull(pts).GetFaces();
+  }
+  int chunks = workers * CHUNKS_PER_THREAD;
+  double min_x = pts[0].GetX();
+  double max_x = min_x;
+  for (const Point& point : pts) {
+    min_x = std::min(min_x, point.GetX());
+    max_x = std::max(max_x, point.GetX());
+  }
+  vector<vector<int>> slabs(chunks); // Разбиение на слои по x
+  for (int i = 0; i < pts_num; ++i) {
+    int slab = (max_x - min_x < EPS) ? i % chunks : (pts[i].GetX() - min_x) / (max_x - min_x) * chunks;
+    slabs[std::min(slab, chunks - 1)].push_back(i);
+  }
+  vector<vector<int>> candidates(chunks); // Вершины оболочек слоёв в исходной нумерации
+  std::atomic<int> next_chunk(0);
+  vector<std::thread> pool;
+  for (int w = 0; w < workers; ++w) { // Потоки разбирают слои из общей очереди
+    pool.emplace_back([&]() {
+      for (int chunk = next_chunk++; chunk < chunks; chunk = next_chunk++) {
+        vector<Point> slab_pts;
+        for (int i : slabs[chunk]) {
+          slab_pts.push_back(pts[i]);
+        }
+        for (int vertex : IncrementalHull(slab_pts).GetVertices()) {
+          candidates[chunk].push_back(slabs[chunk][vertex]);
+        }
+      }
+    });
+  }
+  for (std::thread& thr : pool) {
+    thr.join();
+  }
+  vector<int> ids; // Итоговая оболочка строится по вершинам оболочек слоёв
+  vector<Point> merged;
+  for (const vector<int>& chunk : candidates) {
+    for (int i : chunk) {
+      ids.push_back(i);
+      merged.push_back(pts[i]);
+    }
+  }
+  vector<Face> hull = IncrementalHull(merged).GetFaces();
+  for (Face& face : hull) {
+    face = Face(ids[face.a], ids[face.b], ids[face.c]);
+    face.Rotate();
+  }
+  return hull;
 }
 
-Vector::Vector() :
-    x(0),
-    y(0),
-    z(0) {
+HullMesh::HullMesh(const vector<Point>& points, const vector<Face>& faces) :
+    pts(points),
+    origin(3 * faces.size()),
+    twin(3 * faces.size()) {
+  vector<std::pair<uint64_t, int>> keys; // Ребро (начало, конец) и полуребро, двойник ищется сортировкой
+  for (int f = 0; f < static_cast<int>(faces.size()); ++f) {
+    int v[3] = {faces[f].a, faces[f].b, faces[f].c};
+    for (int i = 0; i < 3; ++i) {
+      origin[3 * f + i] = v[i];
+      keys.emplace_back((static_cast<uint64_t>(v[i]) << 32) | v[(i + 1) % 3], 3 * f + i);
+    }
+  }
+  sort(keys.begin(), keys.end());
+  for (int edge = 0; edge < static_cast<int>(origin.size()); ++edge) {
+    uint64_t key = (static_cast<uint64_t>(origin[Next(edge)]) << 32) | origin[edge];
+    twin[edge] = std::lower_bound(keys.begin(), keys.end(), std::make_pair(key, -1))->second;
+  }
+  BuildHierarchy();
+}
 
+bool HullMesh::PinTetrahedron(int pinned[4]) {
+  if (origin.empty()) {
+    return false;
+  }
+  pinned[0] = pinned[1] = origin[0];
+  for (int v : origin) { // Крайние по x вершины, затем самая далёкая от их прямой и от плоскости
+    if (pts[v].GetX() < pts[pinned[0]].GetX()) {
+      pinned[0] = v;
+    }
+    if (pts[v].GetX() > pts[pinned[1]].GetX()) {
+      pinned[1] = v;
+    }
+  }
+  Vector axis(pts[pinned[0]], pts[pinned[1]]);
+  double best = 0;
+  pinned[2] = -1;
+  for (int v : origin) {
+    double dist = CrossProduct(axis, Vector(pts[pinned[0]], pts[v])).GetLength();
+    if (dist > best) {
+      best = dist;
+      pinned[2] = v;
+    }
+  }
+  if (pinned[2] == -1) {
+    return false;
+  }
+  Vector norm = CrossProduct(axis, Vector(pts[pinned[0]], pts[pinned[2]]));
+  best = 0;
+  pinned[3] = -1;
+  for (int v : origin) {
+    double dist = fabs(DotProduct(norm, Vector(pts[pinned[0]], pts[v])));
+    if (dist > best) {
+      best = dist;
+      pinned[3] = v;
+    }
+  }
+  if (pinned[3] == -1) {
+    return false;
+  }
+  const Point& a = pts[pinned[0]];
+  const Point& b = pts[pinned[1]];
+  const Point& c = pts[pinned[2]];
+  const Point& d = pts[pinned[3]];
+  int orient = Orient3d(a, b, c, d);
+  Vector sum = Vector(a) + Vector(b) + Vector(c) + Vector(d);
+  center = Point(sum.GetX() / 4, sum.GetY() / 4, sum.GetZ() / 4);
+  return orient != 0 && Orient3d(center, b, c, d) == orient && Orient3d(a, center, c, d) == orient &&
+      Orient3d(a, b, center, d) == orient && Orient3d(a, b, c, center) == orient; // Центр считается в double, его положение проверяется точно
 }
 
-Vector::Vector(double x, double y, double z) :
-    x(x),
-    y(y),
-    z(z) {
+void HullMesh::CollectStars(const vector<int>& corners, vector<int>& local, vector<int>& vertices,
+                            vector<int>& star_begin, vector<int>& star) {
+  vertices.clear();
+  for (int v : corners) {
+    if (local[v] == -1) {
+      local[v] = vertices.size();
+      vertices.push_back(v);
+    }
+  }
+  star_begin.assign(vertices.size() + 1, 0);
+  for (int v : corners) {
+    ++star_begin[local[v] + 1];
+  }
+  for (int i = 0; i < static_cast<int>(vertices.size()); ++i) {
+    star_begin[i + 1] += star_begin[i];
+  }
+  star.resize(corners.size());
+  vector<int> filled(star_begin.begin(), star_begin.end() - 1);
+  for (int corner = 0; corner < static_cast<int>(corners.size()); ++corner) {
+    star[filled[local[corners[corner]]]++] = corner / 3;
+  }
+  for (int v : vertices) {
+    local[v] = -1;
+  }
+}
 
+void HullMesh::BuildHierarchy() {
+  int pinned[4];
+  if (!PinTetrahedron(pinned)) { // Плоская или пустая оболочка, запросы перебором
+    return;
+  }
+  int pts_num = pts.size();
+  levels.push_back(Level{origin, vector<int>(origin.size() / 3, -1), vector<int>(), vector<int>()});
+  vector<int> local(pts_num, -1);
+  vector<int> mark(pts_num, -1); // Уровень, на котором вершина удалена или соседствует с удалённой
+  for (int v : pinned) {
+    mark[v] = std::numeric_limits<int>::max();
+  }
+  vector<int> vertices;
+  vector<int> star_begin;
+  vector<int> star;
+  vector<char> removed; // Грани, попавшие в удалённые звёзды
+  vector<int> caps;
+  vector<int> cap_owner; // Для каждой тройки caps - удалённая вершина и её звезда в star
+  vector<int> cap_star;
+  for (int depth = 0; ; ++depth) {
+    const Level& level = levels.back();
+    CollectStars(level.corners, local, vertices, star_begin, star);
+    removed.assign(level.corners.size() / 3, false);
+    caps.clear();
+    cap_owner.clear();
+    cap_star.clear();
+    for (int i = 0; i < static_cast<int>(vertices.size()); ++i) {
+      int v = vertices[i];
+      int degree = star_begin[i + 1] - star_begin[i];
+      if (mark[v] >= depth || degree > MAX_REMOVED_DEGREE) {
+        continue;
+      }
+      int from[MAX_REMOVED_DEGREE];
+      int to[MAX_REMOVED_DEGREE];
+      for (int k = 0; k < degree; ++k) { // Ребро звена напротив вершины в каждой грани звезды
+        const int* corner = &level.corners[3 * star[star_begin[i] + k]];
+        int pos = (corner[0] == v) ? 0 : (corner[1] == v) ? 1 : 2;
+        from[k] = corner[(pos + 1) % 3];
+        to[k] = corner[(pos + 2) % 3];
+      }
+      int ring[MAX_REMOVED_DEGREE];
+      int size = 0;
+      int curr = from[0];
+      do { // Звено вершины - цикл против часовой снаружи
+        ring[size++] = curr;
+        int k = std::find(from, from + degree, curr) - from;
+        curr = (k < degree) ? to[k] : -1;
+      } while (curr != -1 && curr != ring[0] && size < degree);
+      int hole_begin = caps.size();
+      if (curr != ring[0] || size != degree || !CloseHole(ring, size, caps)) {
+        caps.resize(hole_begin);
+        continue;
+      }
+      mark[v] = depth;
+      for (int k = 0; k < degree; ++k) {
+        mark[ring[k]] = depth;
+        removed[star[star_begin[i] + k]] = true;
+      }
+      for (int k = hole_begin; k < static_cast<int>(caps.size()); k += 3) {
+        cap_owner.push_back(v);
+        cap_star.push_back(i);
+      }
+    }
+    if (caps.empty()) { // Ни одну вершину убрать не удалось, уровень верхний
+      break;
+    }
+    Level next;
+    for (int f = 0; f < static_cast<int>(removed.size()); ++f) {
+      if (!removed[f]) {
+        next.corners.insert(next.corners.end(), level.corners.begin() + 3 * f, level.corners.begin() + 3 * f + 3);
+        next.owner.push_back(-1);
+        next.down_begin.push_back(next.down.size());
+        next.down.push_back(f);
+      }
+    }
+    for (int k = 0; k < static_cast<int>(cap_owner.size()); ++k) { // Новая грань лежит над всей звездой удалённой вершины
+      next.corners.insert(next.corners.end(), caps.begin() + 3 * k, caps.begin() + 3 * k + 3);
+      next.owner.push_back(cap_owner[k]);
+      next.down_begin.push_back(next.down.size());
+      next.down.insert(next.down.end(), star.begin() + star_begin[cap_star[k]], star.begin() + star_begin[cap_star[k] + 1]);
+    }
+    next.down_begin.push_back(next.down.size());
+    levels.push_back(std::move(next));
+  }
+  CollectStars(levels.back().corners, local, top_vertices, top_star_begin, top_star);
 }
 
-Vector::Vector(const Point& begin, const Point& end) :
-    x(end.GetX() - begin.GetX()),
-    y(end.GetY() - begin.GetY()),
-    z(end.GetZ() - begin.GetZ()) {
+bool HullMesh::CloseHole(const int* ring, int size, vector<int>& caps) const {
+  auto is_cap = [&](int a, int b, int c) { // Грань выпуклой оболочки звена, видная снаружи, без вершин звена под собой
+    if (Orient3d(pts[a], pts[b], pts[c], center) >= 0) {
+      return false;
+    }
+    for (int k = 0; k < size; ++k) {
+      const Point& other = pts[ring[k]];
+      if (ring[k] == a || ring[k] == b || ring[k] == c) {
+        continue;
+      }
+      if (Orient3d(pts[a], pts[b], pts[c], other) > 0 ||
+          (Orient3d(center, pts[a], pts[b], other) >= 0 && Orient3d(center, pts[b], pts[c], other) >= 0 &&
+           Orient3d(center, pts[c], pts[a], other) >= 0)) {
+        return false;
+      }
+    }
+    return true;
+  };
+  int cycle[MAX_REMOVED_DEGREE];
+  std::copy(ring, ring + size, cycle);
+  for (int left = size; left >= 3; --left) {
+    int i = 0;
+    while (i < left && !is_cap(cycle[(i + left - 1) % left], cycle[i], cycle[(i + 1) % left])) {
+      ++i;
+    }
+    if (i == left) { // Вырожденное звено, вершина остаётся
+      return false;
+    }
+    caps.insert(caps.end(), {cycle[(i + left - 1) % left], cycle[i], cycle[(i + 1) % left]});
+    std::copy(cycle + i + 1, cycle + left, cycle + i);
+  }
+  return true;
+}
 
+int HullMesh::FacesNumber() const {
+  return origin.size() / 3;
 }
 
-Vector::Vector(const Point& point) :
-    Vector(Point(), point) {
+int HullMesh::Origin(int edge) const {
+  return origin[edge];
+}
 
+int HullMesh::Twin(int edge) const {
+  return twin[edge];
 }
 
-double Vector::GetX() const {
-  return x;
+int HullMesh::Neighbour(int face, int i) const {
+  return twin[3 * face + i] / 3;
 }
 
-double Vector::GetY() const {
-  return y;
+int HullMesh::Next(int edge) {
+  return edge - edge % 3 + (edge + 1) % 3;
 }
 
-double Vector::GetZ() const {
-  return z;
+int HullMesh::ExtremePoint(const Vector& dir) const {
+  if (levels.empty()) {
+    return BruteExtreme(dir);
+  }
+  int best = 0;
+  for (int i = 1; i < static_cast<int>(top_vertices.size()); ++i) { // Верхний уровень - O(1) вершин
+    if (DotProduct(dir, Vector(pts[top_vertices[i]])) > DotProduct(dir, Vector(pts[top_vertices[best]]))) {
+      best = i;
+    }
+  }
+  int vertex = top_vertices[best];
+  int cert[3];
+  int cert_size = Certificate(levels.back(), &top_star[top_star_begin[best]], top_star_begin[best + 1] - top_star_begin[best], dir, cert);
+  for (int depth = levels.size() - 1; depth > 0; --depth) {
+    const Level& level = levels[depth];
+    int next_vertex = vertex;
+    bool kept = true;
+    for (int i = 0; i < cert_size; ++i) { // Крайней может стать только вершина, чью дыру закрывает грань сертификата
+      int owner = level.owner[cert[i]];
+      kept = kept && owner == -1;
+      if (owner != -1 && DotProduct(dir, Vector(pts[owner])) > DotProduct(dir, Vector(pts[next_vertex]))) {
+        next_vertex = owner;
+      }
+    }
+    if (kept) { // Все грани сертификата есть и уровнем ниже
+      for (int i = 0; i < cert_size; ++i) {
+        cert[i] = level.down[level.down_begin[cert[i]]];
+      }
+      continue;
+    }
+    const Level& below = levels[depth - 1];
+    int pool[2 * MAX_REMOVED_DEGREE];
+    int pool_size = 0;
+    for (int i = 0; i < cert_size; ++i) {
+      int face = cert[i];
+      for (int k = level.down_begin[face]; k < level.down_begin[face + 1]; ++k) {
+        const int* corner = &below.corners[3 * level.down[k]];
+        bool star_face;
+        if (next_vertex != vertex) { // Звезда новой крайней вершины, не больше MAX_REMOVED_DEGREE граней
+          star_face = level.owner[face] == next_vertex;
+        } else { // Грани у прежней вершины: перешедшие и боковые грани пирамид над дырами, не больше двух на дыру
+          star_face = level.owner[face] == -1 || corner[0] == vertex || corner[1] == vertex || corner[2] == vertex;
+        }
+        if (star_face && std::find(pool, pool + pool_size, level.down[k]) == pool + pool_size) {
+          pool[pool_size++] = level.down[k];
+        }
+      }
+    }
+    cert_size = Certificate(below, pool, pool_size, dir, cert);
+    vertex = next_vertex;
+  }
+  return vertex;
 }
 
-double Vector::GetLength() const {
-  return sqrt(x * x + y * y + z * z);
+int HullMesh::Certificate(const Level& level, const int* pool, int size, const Vector& dir, int* cert) const {
+  cert[0] = pool[0];
+  double length = dir.GetLength();
+  if (length == 0) {
+    return 1;
+  }
+  Vector unit = dir * (1 / length);
+  double best = std::numeric_limits<double>::max(); // Расстояние от dir до конуса, 0 - dir внутри
+  int count = 1;
+  for (int i = 0; i < size; ++i) {
+    Vector first = UnitNormal(level, pool[i]);
+    double first_dot = DotProduct(unit, first);
+    double miss = (first_dot > 0) ? sqrt(std::max(0.0, 1 - first_dot * first_dot)) : 2 - first_dot;
+    if (miss < best) {
+      best = miss;
+      count = 1;
+      cert[0] = pool[i];
+    }
+    for (int j = i + 1; j < size; ++j) {
+      Vector second = UnitNormal(level, pool[j]);
+      double second_dot = DotProduct(unit, second);
+      double cos = DotProduct(first, second);
+      double gram = 1 - cos * cos;
+      double a = (first_dot - cos * second_dot) / gram;
+      double b = (second_dot - cos * first_dot) / gram;
+      if (gram > CERTIFICATE_EPS && a >= 0 && b >= 0) { // Проекция dir на плоскость двух нормалей между ними
+        miss = (unit - a * first - b * second).GetLength();
+        if (miss < best) {
+          best = miss;
+          count = 2;
+          cert[0] = pool[i];
+          cert[1] = pool[j];
+        }
+      }
+      for (int l = j + 1; l < size; ++l) {
+        Vector third = UnitNormal(level, pool[l]);
+        double det = DotProduct(first, CrossProduct(second, third));
+        if (fabs(det) > CERTIFICATE_EPS && DotProduct(unit, CrossProduct(second, third)) / det >= 0 &&
+            DotProduct(first, CrossProduct(unit, third)) / det >= 0 && DotProduct(first, CrossProduct(second, unit)) / det >= 0) {
+          cert[0] = pool[i];
+          cert[1] = pool[j];
+          cert[2] = pool[l];
+          return 3;
+        }
+      }
+    }
+  }
+  return count;
 }
 
-Vector& Vector::operator*=(double mod) {
-  x *= mod;
-  y *= mod;
-  z *= mod;
-  return *this;
+Vector HullMesh::UnitNormal(const Level& level, int face) const {
+  const int* corner = &level.corners[3 * face];
+  Vector norm = CrossProduct(Vector(pts[corner[0]], pts[corner[1]]), Vector(pts[corner[0]], pts[corner[2]]));
+  double length = norm.GetLength();
+  return (length > 0) ? norm * (1 / length) : norm;
 }
 
-Vector operator*(Vector vec, double mod) {
-  vec *= mod;
-  return vec;
+int HullMesh::BruteExtreme(const Vector& dir) const {
+  int best = -1;
+  for (int v : origin) {
+    if (best == -1 || DotProduct(dir, Vector(pts[v])) > DotProduct(dir, Vector(pts[best]))) {
+      best = v;
+    }
+  }
+  return best;
 }
 
-Vector operator*(double mod, const Vector& vec) {
-  return vec * mod;
+bool HullMesh::Contains(const Point& point) const {
+  int face = -1;
+  if (!levels.empty()) {
+    const Level& top = levels.back();
+    for (int f = 0; face == -1 && f < static_cast<int>(top.owner.size()); ++f) {
+      if (InCone(top, f, point)) {
+        face = f;
+      }
+    }
+    for (int depth = levels.size() - 1; depth > 0 && face != -1; --depth) { // Грань уровня ниже - среди лежащих под текущей
+      const Level& level = levels[depth];
+      int begin = level.down_begin[face];
+      int end = level.down_begin[face + 1];
+      face = (level.owner[face] == -1) ? level.down[begin] : -1;
+      for (int k = begin; face == -1 && k < end; ++k) {
+        if (InCone(levels[depth - 1], level.down[k], point)) {
+          face = level.down[k];
+        }
+      }
+    }
+  }
+  if (face != -1) {
+    return !Sees(point, face);
+  }
+  for (int f = 0; f < FacesNumber(); ++f) { // Плоская оболочка: точка внутри, если не выходит ни за одну плоскость граней
+    if (Sees(point, f)) {
+      return false;
+    }
+  }
+  return FacesNumber() > 0;
 }
 
-Vector& Vector::operator+=(const Vector& other) {
-  x += other.x;
-  y += other.y;
-  z += other.z;
-  return *this;
+bool HullMesh::InCone(const Level& level, int face, const Point& point) const {
+  const Point& a = pts[level.corners[3 * face]];
+  const Point& b = pts[level.corners[3 * face + 1]];
+  const Point& c = pts[level.corners[3 * face + 2]];
+  return Orient3d(a, b, c, center) < 0 && Orient3d(center, a, b, point) >= 0 &&
+      Orient3d(center, b, c, point) >= 0 && Orient3d(center, c, a, point) >= 0;
 }
 
-Vector operator+(Vector lhs, const Vector& rhs) {
-  lhs += rhs;
-  return lhs;
+bool HullMesh::Sees(const Point& point, int face) const {
+  return Orient3d(pts[origin[3 * face]], pts[origin[3 * face + 1]], pts[origin[3 * face + 2]], point) > 0;
 }
 
-Vector& Vector::operator-=(const Vector& other) {
-  x -= other.x;
-  y -= other.y;
-  z -= other.z;
-  return *this;
+bool FaceCompare::operator()(const Face& lhs, const Face& rhs) {
+  return (lhs.a < rhs.a ||
+         (lhs.a == rhs.a && lhs.b < rhs.b) ||
+         (lhs.a == rhs.a && lhs.b == rhs.b && lhs.c < rhs.c));
 }
 
-Vector operator-(Vector lhs, const Vector& rhs) {
-  lhs -= rhs;
-  return lhs;
+bool ComparePoints(const Point& lhs, const Point& rhs) {
+  return (lhs.GetZ() < rhs.GetZ() - EPS ||
+         (fabs(lhs.GetZ() - rhs.GetZ()) < EPS && lhs.GetX() < rhs.GetX() - EPS) ||
+         (fabs(lhs.GetZ() - rhs.GetZ()) < EPS && fabs(lhs.GetX() - rhs.GetX()) < EPS && lhs.GetY() < rhs.GetY() - EPS));
 }
 
-istream& operator>>(istream& in, Vector& vec) {
-  in >> vec.x >> vec.y >> vec.z;
-  return in;
+Plane::Plane(const Point& first_point, const Point& second_point, const Point& third_point) {
+  Vector norm = CrossProduct(Vector(first_point, second_point), Vector(first_point, third_point));
+  a = norm.GetX();
+  b = norm.GetY();
+  c = norm.GetZ();
+  d = -a * first_point.GetX() - b * first_point.GetY() - c * first_point.GetZ();
 }
 
-ostream& operator<<(ostream& out, const Vector& vec) {
-  out << vec.x << " " << vec.y << " " << vec.z;
-  return out;
+Vector Plane::NormVector() {
+  return Vector(a, b, c);
 }
 
-Point& Point::operator+=(const Vector& vec) {
-  x += vec.GetX();
-  y += vec.GetY();
-  return *this;
+Face::Face(int a, int b, int c) :
+    a(a),
+    b(b),
+    c(c) {
+
 }
 
-Point operator+(Point point, const Vector& vec) {
-  point += vec;
-  return point;
+void Face::Rotate() {
+  while (a > b || a > c) {
+    int first = a;
+    a = b;
+    b = c;
+    c = first;
+  }
 }
 
-bool Face::operator==(const Face& other) {
+bool Face::operator==(const Face& other) const {
   return (a == other.a && b == other.b && c == other.c);
 }
+
+size_t FaceHash::operator()(const Face& face) const {
+  uint64_t hash = static_cast<uint32_t>(face.a);
+  hash = hash * 0x9E3779B97F4A7C15ull + static_cast<uint32_t>(face.b);
+  hash = hash * 0x9E3779B97F4A7C15ull + static_cast<uint32_t>(face.c);
+  return hash ^ (hash >> 29);
+}
@@ -2,264 +2,707 @@
 #include <cmath>
 #include <vector>
 #include <algorithm>
+#include <cstdint>
+#include <thread>
+#include <string>
+#include "../geometry.h"
+#include "../predicates.h"
+#include "../pointio.h"
 
 using std::cin;
 using std::cout;
-using std::istream;
-using std::ostream;
+using std::string;
+using std::string_view;
 using std::vector;
+using std::pair;
 
-static const double EPS = std::numeric_limits<double>::epsilon();
+static const double TOUCH_EPS = 8 * std::numeric_limits<double>::epsilon(); // относительная погрешность десятичного ввода и сумм вершин
 
-class Vector;
+static const int MIN_HULL_CHUNK = 1 << 14; // меньшие куски оболочки не стоят отдельного потока
+static const int64_t MAX_EXACT_COORD = int64_t(1) << 60; // векторные произведения таких координат помещаются в __int128
 
-class Point {
+typedef BasicPoint<double, 2> Point;
+typedef BasicVector<double, 2> Vector;
+typedef BasicPoint<int64_t, 2> IntPoint; // точный путь для целочисленных входов
+typedef BasicVector<int64_t, 2> IntVector;
+
+class ConvexPolygon { // выпуклый многоугольник, подготовленный для многих запросов принадлежности
   public:
-    Point();
-    Point(double x, double y);
-    double GetX() const;
-    double GetY() const;
-    Point& operator+=(const Vector& vec);
-    friend bool operator==(const Point& lhs, const Point& rhs);
-    friend Point operator+(Point point, const Vector& vec);
-    friend istream& operator>>(istream& in, Point& point);
-    friend ostream& operator<<(ostream& out, const Point& point);
+    ConvexPolygon(const vector<Point>& set); // вершины против часовой, как в результате MinkSum
+    bool Contains(const Point& p) const; // бинпоиск по веерной триангуляции из нижней вершины, O(log n)
+    vector<uint64_t> ContainsBatch(const vector<double>& qx, const vector<double>& qy) const; // i-й бит - ответ для i-й точки
+    Vector Extreme(const Vector& dir) const; // крайняя в направлении dir вершина, бинпоиск по полярному углу рёбер, O(log n)
+    bool Intersects(const ConvexPolygon& other, Vector& dir) const; // GJK без построения MinkSum, dir - начальное направление, при NO - разделяющее
   private:
-    double x;
-    double y;
+    bool Contains(double x, double y) const;
+    Vector Vertex(int i) const; // i-я вершина, нулевая - нижняя
+    vector<double> xs; // вершины от нижней против часовой, точно как во вводе
+    vector<double> ys;
+};
+
+struct Separation { // расстояние между многоугольниками или глубина их проникновения
+  bool intersect;
+  double distance; // при пересечении - глубина проникновения
+  Point first_witness; // ближайшие точки, при пересечении сдвиг второго многоугольника на их разность разводит многоугольники
+  Point second_witness;
 };
 
-class Vector {
+class CollisionWorld { // все пересекающиеся пары среди многих выпуклых многоугольников
   public:
-    Vector();
-    Vector(double x, double y);
-    Vector(const Point& begin, const Point& end);
-    explicit Vector(const Point& point);
-    double GetX() const;
-    double GetY() const;
-    double GetLength() const;
-    double GetPolarAngle() const;
-    Vector& operator*=(double mod);
-    friend Vector operator*(Vector vec, double mod);
-    friend Vector operator*(double mod, const Vector& vec);
-    Vector& operator+=(const Vector& other);
-    friend Vector operator+(Vector lhs, const Vector& rhs);
-    Vector& operator-=(const Vector& other);
-    friend Vector operator-(Vector lhs, const Vector& rhs);
-    friend istream& operator>>(istream& in, Vector& vec);
-    friend ostream& operator<<(ostream& out, const Vector& vec);
+    CollisionWorld(const vector<vector<Point>>& sets); // каждый многоугольник против часовой
+    vector<pair<int, int>> FindPairs(int threads = 0) const; // 0 - все аппаратные потоки
   private:
-    double x;
-    double y;
+    struct Box { // ограничивающий прямоугольник
+      double min_x;
+      double max_x;
+      double min_y;
+      double max_y;
+      int index;
+    };
+    void Sweep(int begin, int end, vector<pair<int, int>>& found) const; // sweep and prune для боксов [begin, end)
+
+    vector<ConvexPolygon> polygons;
+    vector<Box> boxes; // по возрастанию min_x
 };
 
-bool ComparePoints(const Point& lhs, const Point& rhs); // для поиска левой нижней точки
-void SetPrepare(vector<Point>& set); // разворот в порядке против часовой, поиск левой нижней точки
-double DotProduct(const Vector& first_vec, const Vector& second_vec); // скалярное произведение
-vector<Point> MinkSum(vector<Point> first_set, vector<Point> second_set);
-bool IsInSet(const Point& p, const vector<Point>& set);
-double VectorComp(const Vector& first_vec, const Vector& second_vec); // векторное произведение
-
-int main() {
-  int first_size;
-  int second_size;
-  cin >> first_size;
-  vector<Point> first_set(first_size);
-  for (int i = 0; i < first_size; ++i) {
-    cin >> first_set[i];
-  }
-  cin >> second_size;
-  vector<Point> second_set(second_size);
-  for (int i = 0; i < second_size; ++i) {
-    cin >> second_set[i];
-    second_set[i] = Point() + -1 * Vector(second_set[i]);
-  }
-  vector<Point> mink_sum = MinkSum(first_set, second_set);
-  cout << (IsInSet(Point(), mink_sum) ? "YES\n" : "NO\n");
+template <typename Scalar>
+bool ComparePoints(const BasicPoint<Scalar, 2>& lhs, const BasicPoint<Scalar, 2>& rhs); // для поиска левой нижней точки
+template <typename Scalar>
+void SetPrepare(vector<BasicPoint<Scalar, 2>>& set); // разворот в порядке против часовой, если он был по часовой, поиск левой нижней точки
+template <typename Scalar>
+bool XLess(const BasicPoint<Scalar, 2>& lhs, const BasicPoint<Scalar, 2>& rhs); // порядок для монотонной цепочки
+template <typename Scalar, typename Iter>
+void HalfHull(Iter begin, Iter end, vector<BasicPoint<Scalar, 2>>& chain); // нижняя цепочка отсортированных точек, коллинеарные выбрасываются
+template <typename Scalar>
+vector<BasicPoint<Scalar, 2>> ConvexHull(vector<BasicPoint<Scalar, 2>> points, int threads = 0); // против часовой от левой нижней точки, готово для MinkSum
+template <typename Scalar>
+vector<BasicPoint<Scalar, 2>> MinkSum(vector<BasicPoint<Scalar, 2>> first_set, vector<BasicPoint<Scalar, 2>> second_set);
+template <typename Scalar>
+void EdgesSoA(const vector<BasicPoint<Scalar, 2>>& set, vector<Scalar>& dx, vector<Scalar>& dy); // рёбра многоугольника структурой массивов
+template <typename Scalar>
+bool IsInSet(const BasicPoint<Scalar, 2>& p, const vector<BasicPoint<Scalar, 2>>& set);
+template <typename Scalar>
+typename Product<Scalar>::Type VectorComp(const BasicVector<Scalar, 2>& first_vec, const BasicVector<Scalar, 2>& second_vec); // векторное произведение
+template <typename Scalar>
+typename Product<Scalar>::Type Cross(Scalar first_x, Scalar first_y, Scalar second_x, Scalar second_y); // то же без временных векторов
+template <typename Scalar>
+int Orient(const BasicPoint<Scalar, 2>& a, const BasicPoint<Scalar, 2>& b, const BasicPoint<Scalar, 2>& c); // знак (b - a) x (c - a)
+int Orient(const Point& a, const Point& b, const Point& c);
+int Orient(double ax, double ay, double bx, double by, double cx, double cy); // ноль в пределах допуска касания, иначе точный Orient2d
+template <typename Scalar>
+int EdgesTurn(const BasicPoint<Scalar, 2>& a, const BasicPoint<Scalar, 2>& b, const BasicPoint<Scalar, 2>& c, const BasicPoint<Scalar, 2>& d); // знак (b - a) x (d - c)
+int EdgesTurn(const Point& a, const Point& b, const Point& c, const Point& d);
+Separation PolygonsSeparation(vector<Point> first_set, vector<Point> second_set); // рёбра разности сливаются как в MinkSum, O(n + m)
+int Sign(double val, double scale); // знак с допуском TOUCH_EPS * scale, единственный допуск для double
+int Sign(__int128 val); // точный знак
+bool ReadCoords(InputReader& in, vector<string_view>& coords); // координаты многоугольника строками, чтобы выбрать арифметику до разбора; false при обрыве или нечисловом токене
+bool ReadValues(InputReader& in, vector<double>& coords); // в бинарном формате координаты уже числа
+bool IsIntegral(const vector<string_view>& coords); // все координаты целые и не больше MAX_EXACT_COORD по модулю
+bool IsIntegral(const vector<double>& coords);
+void ParseCoord(string_view token, double& coord);
+void ParseCoord(string_view token, int64_t& coord);
+void ParseCoord(double value, double& coord);
+void ParseCoord(double value, int64_t& coord);
+template <typename Scalar, typename Token>
+vector<BasicPoint<Scalar, 2>> ParseSet(const vector<Token>& coords);
+template <typename Token>
+bool SetsIntersect(const vector<Token>& first_coords, const vector<Token>& second_coords);
+template <typename Scalar>
+bool OriginInDifference(const vector<BasicPoint<Scalar, 2>>& first_set, vector<BasicPoint<Scalar, 2>> second_set); // множества пересекаются, если начало координат в их разности
+bool AngleLess(const Vector& lhs, const Vector& rhs); // сравнение полярных углов в [0, 2pi)
+bool NearestSimplex(Vector* simplex, int& size, Vector& dir); // шаг GJK: оставляет ближайшую к началу координат часть симплекса
+
+int main(int argc, char** argv) { // --f64/--f32 - бинарный ввод
+  InputReader reader(FormatFromArgs(argc, argv));
+  bool intersect;
+  bool read;
+  if (reader.GetFormat() == InputFormat::TEXT) {
+    vector<string_view> first_coords;
+    vector<string_view> second_coords;
+    read = ReadCoords(reader, first_coords) && ReadCoords(reader, second_coords);
+    intersect = read && SetsIntersect(first_coords, second_coords);
+  } else {
+    vector<double> first_coords;
+    vector<double> second_coords;
+    read = ReadValues(reader, first_coords) && ReadValues(reader, second_coords);
+    intersect = read && SetsIntersect(first_coords, second_coords);
+  }
+  if (!read) {
+    std::cerr << "bad input\n";
+    return 1;
+  }
+  cout << (intersect ? "YES\n" : "NO\n");
   return 0;
 }
 
-double VectorComp(const Vector& first_vec, const Vector& second_vec) {
-  return first_vec.GetX() * second_vec.GetY() - first_vec.GetY() * second_vec.GetX();
+template <typename Token>
+bool SetsIntersect(const vector<Token>& first_coords, const vector<Token>& second_coords) {
+  if (IsIntegral(first_coords) && IsIntegral(second_coords)) { // точная проверка в целых числах
+    return OriginInDifference(ParseSet<int64_t>(first_coords), ParseSet<int64_t>(second_coords));
+  }
+  return OriginInDifference(ParseSet<double>(first_coords), ParseSet<double>(second_coords));
 }
 
-bool IsInSet(const Point& p, const vector<Point>& set) {
-  int size = set.size();
-  for (int i = 0; i < size; ++i) {
-    if (VectorComp(Vector(set[i], set[(i + 1) % size]), Vector(set[i], Point())) < -EPS) {
+template <typename Scalar>
+bool OriginInDifference(const vector<BasicPoint<Scalar, 2>>& first_set, vector<BasicPoint<Scalar, 2>> second_set) {
+  for (BasicPoint<Scalar, 2>& p : second_set) {
+    p = BasicPoint<Scalar, 2>() + Scalar(-1) * BasicVector<Scalar, 2>(p);
+  }
+  return IsInSet(BasicPoint<Scalar, 2>(), MinkSum(first_set, second_set));
+}
+
+bool ReadCoords(InputReader& in, vector<string_view>& coords) {
+  int64_t size = 0;
+  if (!in.ReadCount(size) || size < 0) {
+    return false;
+  }
+  coords.resize(2 * size);
+  for (string_view& coord : coords) {
+    coord = in.NextToken();
+    double value;
+    const char* begin = coord.data() + (!coord.empty() && coord[0] == '+'); // from_chars не принимает '+'
+    std::from_chars_result parsed = std::from_chars(begin, coord.data() + coord.size(), value);
+    if (parsed.ec != std::errc() || parsed.ptr != coord.data() + coord.size()) {
       return false;
     }
   }
   return true;
 }
 
-bool ComparePoints(const Point& lhs, const Point& rhs) {
-  return lhs.GetY() < rhs.GetY() || (lhs.GetY() == rhs.GetY() && lhs.GetX() < rhs.GetX());
+bool ReadValues(InputReader& in, vector<double>& coords) {
+  int64_t size = 0;
+  if (!in.ReadCount(size) || size < 0) {
+    return false;
+  }
+  coords.resize(2 * size);
+  return in.ReadCoords(coords.data(), coords.size());
 }
 
-void SetPrepare(vector<Point>& set) {
-  reverse(set.begin(), set.end());
-  auto beg_point = min_element(set.begin(), set.end(), ComparePoints);
-  rotate(set.begin(), beg_point, set.end());
+bool IsIntegral(const vector<double>& coords) {
+  for (double coord : coords) { // такие double точно переводятся в int64_t
+    if (coord != std::floor(coord) || std::fabs(coord) > MAX_EXACT_COORD) {
+      return false;
+    }
+  }
+  return true;
 }
 
-vector<Point> MinkSum(vector<Point> first_set, vector<Point> second_set) {
-  vector<Point> result;
-  SetPrepare(first_set);
-  SetPrepare(second_set);
-  int first_ptr = 0; // указатель на элемент первого множества
-  int second_ptr = 0; // указатель на элемент второго множества
-  int first_size = first_set.size();
-  int second_size = second_set.size();
-  while (first_ptr < first_size || second_ptr < second_size) { // цикл, создающий сумму
-    Vector first_vec(first_set[first_ptr % first_size], first_set[(first_ptr + 1) % first_size]);
-    Vector second_vec(second_set[second_ptr % second_size], second_set[(second_ptr + 1) % second_size]);
-    result.push_back(Point() + Vector(first_set[first_ptr % first_size]) + Vector(second_set[second_ptr % second_size]));
-    if (second_ptr == second_size || (first_ptr < first_size && VectorComp(first_vec, second_vec) > EPS)) { // выбор указателя, который нужно сдвинуть
-      ++first_ptr;
-    } else {
-      ++second_ptr;
+bool IsIntegral(const vector<string_view>& coords) {
+  for (string_view coord : coords) {
+    int begin = (!coord.empty() && (coord[0] == '-' || coord[0] == '+')) ? 1 : 0;
+    int digits = coord.size() - begin;
+    if (digits == 0 || digits > 18) { // 18 цифр точно помещаются в int64_t
+      return false;
+    }
+    for (int i = begin; i < static_cast<int>(coord.size()); ++i) {
+      if (coord[i] < '0' || coord[i] > '9') {
+        return false;
+      }
+    }
+    int64_t value;
+    ParseCoord(coord, value);
+    if (value > MAX_EXACT_COORD || value < -MAX_EXACT_COORD) {
+      return false;
     }
   }
-  return result;
+  return true;
 }
 
-double DotProduct(const Vector& first_vec, const Vector& second_vec) {
-  return first_vec.GetX() * second_vec.GetX() +
-         first_vec.GetY() * second_vec.GetY();
+void ParseCoord(string_view token, double& coord) {
+  const char* begin = token.data() + (!token.empty() && token[0] == '+'); // from_chars не принимает '+'
+  std::from_chars(begin, token.data() + token.size(), coord);
 }
 
-Point::Point() :
-    x(0),
-    y(0) {
-
+void ParseCoord(string_view token, int64_t& coord) {
+  const char* begin = token.data() + (!token.empty() && token[0] == '+');
+  std::from_chars(begin, token.data() + token.size(), coord);
 }
 
-Point::Point(double x, double y) :
-    x(x),
-    y(y) {
+void ParseCoord(double value, double& coord) {
+  coord = value;
+}
 
+void ParseCoord(double value, int64_t& coord) {
+  coord = static_cast<int64_t>(value);
 }
 
-double Point::GetX() const {
-  return x;
+template <typename Scalar, typename Token>
+vector<BasicPoint<Scalar, 2>> ParseSet(const vector<Token>& coords) {
+  int size = coords.size() / 2;
+  vector<BasicPoint<Scalar, 2>> set;
+  set.reserve(size);
+  for (int i = 0; i < size; ++i) {
+    Scalar x;
+    Scalar y;
+    ParseCoord(coords[2 * i], x);
+    ParseCoord(coords[2 * i + 1], y);
+    set.emplace_back(x, y);
+  }
+  return set;
 }
 
-double Point::GetY() const {
-  return y;
+int Sign(double val, double scale) {
+  double tolerance = TOUCH_EPS * scale;
+  return (val > tolerance) - (val < -tolerance);
 }
 
-bool operator==(const Point& lhs, const Point& rhs) {
-  return lhs.x == rhs.x && lhs.y == rhs.y;
+int Sign(__int128 val) {
+  return (val > 0) - (val < 0);
 }
 
-Point& Point::operator+=(const Vector& vec) {
-  x += vec.GetX();
-  y += vec.GetY();
-  return *this;
+template <typename Scalar>
+typename Product<Scalar>::Type Cross(Scalar first_x, Scalar first_y, Scalar second_x, Scalar second_y) {
+  typedef typename Product<Scalar>::Type Wide;
+  return Wide(first_x) * second_y - Wide(first_y) * second_x;
 }
 
-Point operator+(Point point, const Vector& vec) {
-  point += vec;
-  return point;
+template <typename Scalar>
+typename Product<Scalar>::Type VectorComp(const BasicVector<Scalar, 2>& first_vec, const BasicVector<Scalar, 2>& second_vec) {
+  return Cross(first_vec.GetX(), first_vec.GetY(), second_vec.GetX(), second_vec.GetY());
 }
 
-istream& operator>>(istream& in, Point& point) {
-  in >> point.x >> point.y;
-  return in;
+template <typename Scalar>
+int Orient(const BasicPoint<Scalar, 2>& a, const BasicPoint<Scalar, 2>& b, const BasicPoint<Scalar, 2>& c) {
+  return Sign(Cross(b.GetX() - a.GetX(), b.GetY() - a.GetY(), c.GetX() - a.GetX(), c.GetY() - a.GetY()));
 }
 
-ostream& operator<<(ostream& out, const Point& point) {
-  out << point.x << " " << point.y;
-  return out;
+int Orient(const Point& a, const Point& b, const Point& c) {
+  return Orient(a.GetX(), a.GetY(), b.GetX(), b.GetY(), c.GetX(), c.GetY());
 }
 
-Vector::Vector() :
-    x(0),
-    y(0) {
+int Orient(double ax, double ay, double bx, double by, double cx, double cy) {
+  double first_x = bx - ax;
+  double first_y = by - ay;
+  double second_x = cx - ax;
+  double second_y = cy - ay;
+  double reach = std::max({fabs(ax), fabs(ay), fabs(bx), fabs(by), fabs(cx), fabs(cy)}); // порядок ошибки округления точек
+  if (Sign(first_x * second_y - first_y * second_x, reach * (fabs(first_x) + fabs(first_y) + fabs(second_x) + fabs(second_y))) == 0) { // касание
+    return 0;
+  }
+  return Orient2d(ax, ay, bx, by, cx, cy);
+}
 
+template <typename Scalar>
+int EdgesTurn(const BasicPoint<Scalar, 2>& a, const BasicPoint<Scalar, 2>& b, const BasicPoint<Scalar, 2>& c, const BasicPoint<Scalar, 2>& d) {
+  return Sign(Cross(b.GetX() - a.GetX(), b.GetY() - a.GetY(), d.GetX() - c.GetX(), d.GetY() - c.GetY()));
 }
 
-Vector::Vector(double x, double y) :
-    x(x),
-    y(y) {
+int EdgesTurn(const Point& a, const Point& b, const Point& c, const Point& d) {
+  return CrossSign(a, b, c, d);
+}
 
+template <typename Scalar>
+bool IsInSet(const BasicPoint<Scalar, 2>& p, const vector<BasicPoint<Scalar, 2>>& set) {
+  int size = set.size();
+  for (int i = 0; i < size; ++i) {
+    if (Orient(set[i], set[(i + 1) % size], p) < 0) {
+      return false;
+    }
+  }
+  return true;
 }
 
-Vector::Vector(const Point& begin, const Point& end) :
-    x(end.GetX() - begin.GetX()),
-    y(end.GetY() - begin.GetY()) {
+template <typename Scalar>
+bool ComparePoints(const BasicPoint<Scalar, 2>& lhs, const BasicPoint<Scalar, 2>& rhs) {
+  return lhs.GetY() < rhs.GetY() || (lhs.GetY() == rhs.GetY() && lhs.GetX() < rhs.GetX());
+}
 
+template <typename Scalar>
+void SetPrepare(vector<BasicPoint<Scalar, 2>>& set) {
+  int size = set.size();
+  int orient = 0;
+  for (int i = 0; i < size && orient == 0; ++i) { // первый невырожденный поворот задаёт обход
+    const BasicPoint<Scalar, 2>& curr = set[i];
+    const BasicPoint<Scalar, 2>& next = set[(i + 1) % size];
+    const BasicPoint<Scalar, 2>& last = set[(i + 2) % size];
+    orient = Orient(curr, next, last);
+  }
+  if (orient <= 0) {
+    reverse(set.begin(), set.end());
+  }
+  auto beg_point = min_element(set.begin(), set.end(), ComparePoints<Scalar>);
+  rotate(set.begin(), beg_point, set.end());
 }
 
-Vector::Vector(const Point& point) :
-    Vector(Point(), point) {
+template <typename Scalar>
+bool XLess(const BasicPoint<Scalar, 2>& lhs, const BasicPoint<Scalar, 2>& rhs) {
+  return lhs.GetX() < rhs.GetX() || (lhs.GetX() == rhs.GetX() && lhs.GetY() < rhs.GetY());
+}
 
+template <typename Scalar, typename Iter>
+void HalfHull(Iter begin, Iter end, vector<BasicPoint<Scalar, 2>>& chain) {
+  chain.clear();
+  for (Iter it = begin; it != end; ++it) {
+    while (chain.size() >= 2) {
+      const BasicPoint<Scalar, 2>& prev = chain[chain.size() - 2];
+      const BasicPoint<Scalar, 2>& last = chain.back();
+      if (Orient(prev, last, *it) > 0) {
+        break; // левый поворот
+      }
+      chain.pop_back();
+    }
+    chain.push_back(*it);
+  }
 }
 
-double Vector::GetX() const {
-  return x;
+template <typename Scalar>
+vector<BasicPoint<Scalar, 2>> ConvexHull(vector<BasicPoint<Scalar, 2>> points, int threads) {
+  typedef BasicPoint<Scalar, 2> Point;
+  int size = points.size();
+  int hardware = std::thread::hardware_concurrency();
+  int workers = std::max(1, std::min(threads ? threads : hardware, size / MIN_HULL_CHUNK));
+  vector<int> bounds(workers + 1);
+  for (int w = 0; w <= workers; ++w) {
+    bounds[w] = static_cast<long long>(size) * w / workers;
+  }
+  vector<std::thread> pool;
+  for (int w = 0; w < workers; ++w) { // куски сортируются параллельно
+    pool.emplace_back([&, w]() {
+      sort(points.begin() + bounds[w], points.begin() + bounds[w + 1], XLess<Scalar>);
+    });
+  }
+  for (std::thread& thr : pool) {
+    thr.join();
+  }
+  for (int width = 1; width < workers; width *= 2) { // и попарно сливаются, слияния одного уровня тоже параллельны
+    pool.clear();
+    for (int w = 0; w + width < workers; w += 2 * width) {
+      pool.emplace_back([&, w, width]() {
+        inplace_merge(points.begin() + bounds[w], points.begin() + bounds[w + width],
+                      points.begin() + bounds[std::min(w + 2 * width, workers)], XLess<Scalar>);
+      });
+    }
+    for (std::thread& thr : pool) {
+      thr.join();
+    }
+  }
+  points.erase(unique(points.begin(), points.end()), points.end());
+  size = points.size();
+  if (size < 3) {
+    return points;
+  }
+  workers = std::max(1, std::min(workers, size / MIN_HULL_CHUNK));
+  vector<vector<Point>> lower(workers);
+  vector<vector<Point>> upper(workers);
+  pool.clear();
+  for (int w = 0; w < workers; ++w) { // цепочки кусков, оболочка объединения - оболочка их вершин
+    pool.emplace_back([&, w]() {
+      auto begin = points.begin() + static_cast<long long>(size) * w / workers;
+      auto end = points.begin() + static_cast<long long>(size) * (w + 1) / workers;
+      HalfHull(begin, end, lower[w]);
+      HalfHull(std::make_reverse_iterator(end), std::make_reverse_iterator(begin), upper[w]);
+    });
+  }
+  for (std::thread& thr : pool) {
+    thr.join();
+  }
+  vector<Point> lower_pts;
+  vector<Point> upper_pts;
+  for (int w = 0; w < workers; ++w) {
+    lower_pts.insert(lower_pts.end(), lower[w].begin(), lower[w].end());
+    upper_pts.insert(upper_pts.end(), upper[workers - 1 - w].begin(), upper[workers - 1 - w].end());
+  }
+  vector<Point> lower_chain;
+  vector<Point> upper_chain;
+  HalfHull(lower_pts.begin(), lower_pts.end(), lower_chain);
+  HalfHull(upper_pts.begin(), upper_pts.end(), upper_chain);
+  vector<Point> hull(lower_chain.begin(), lower_chain.end() - 1); // концы цепочек общие
+  hull.insert(hull.end(), upper_chain.begin(), upper_chain.end() - 1);
+  rotate(hull.begin(), min_element(hull.begin(), hull.end(), ComparePoints<Scalar>), hull.end());
+  return hull;
+}
+
+template <typename Scalar>
+void EdgesSoA(const vector<BasicPoint<Scalar, 2>>& set, vector<Scalar>& dx, vector<Scalar>& dy) {
+  int size = set.size();
+  dx.resize(size);
+  dy.resize(size);
+  for (int i = 0; i < size; ++i) {
+    int next = (i + 1 == size) ? 0 : i + 1;
+    dx[i] = set[next].GetX() - set[i].GetX();
+    dy[i] = set[next].GetY() - set[i].GetY();
+  }
 }
 
-double Vector::GetY() const {
-  return y;
+template <typename Scalar>
+vector<BasicPoint<Scalar, 2>> MinkSum(vector<BasicPoint<Scalar, 2>> first_set, vector<BasicPoint<Scalar, 2>> second_set) {
+  vector<BasicPoint<Scalar, 2>> result;
+  SetPrepare(first_set);
+  SetPrepare(second_set);
+  int first_ptr = 0; // указатель на элемент первого множества
+  int second_ptr = 0; // указатель на элемент второго множества
+  int first_size = first_set.size();
+  int second_size = second_set.size();
+  vector<Scalar> first_dx; // рёбра считаются один раз, без временных векторов и взятия по модулю
+  vector<Scalar> first_dy;
+  vector<Scalar> second_dx;
+  vector<Scalar> second_dy;
+  EdgesSoA(first_set, first_dx, first_dy);
+  EdgesSoA(second_set, second_dx, second_dy);
+  result.reserve(first_size + second_size);
+  while (first_ptr < first_size || second_ptr < second_size) { // цикл, создающий сумму
+    int first_cur = (first_ptr < first_size) ? first_ptr : 0;
+    int second_cur = (second_ptr < second_size) ? second_ptr : 0;
+    result.emplace_back(first_set[first_cur].GetX() + second_set[second_cur].GetX(),
+                        first_set[first_cur].GetY() + second_set[second_cur].GetY());
+    if (second_ptr == second_size || (first_ptr < first_size &&
+        Cross(first_dx[first_ptr], first_dy[first_ptr], second_dx[second_ptr], second_dy[second_ptr]) > 0)) { // выбор указателя, который нужно сдвинуть
+      ++first_ptr;
+    } else {
+      ++second_ptr;
+    }
+  }
+  return result;
 }
 
-double Vector::GetLength() const {
-  return sqrt(x * x + y * y);
+Separation PolygonsSeparation(vector<Point> first_set, vector<Point> second_set) {
+  for (Point& p : second_set) {
+    p = Point() + -1.0 * Vector(p);
+  }
+  SetPrepare(first_set);
+  SetPrepare(second_set);
+  int first_ptr = 0;
+  int second_ptr = 0;
+  int first_size = first_set.size();
+  int second_size = second_set.size();
+  Separation result{true, std::numeric_limits<double>::max(), Point(), Point()}; // ближайшая к началу координат точка границы разности
+  while (first_ptr < first_size || second_ptr < second_size) { // обход рёбер разности, как в MinkSum
+    int first_cur = (first_ptr < first_size) ? first_ptr : 0;
+    int second_cur = (second_ptr < second_size) ? second_ptr : 0;
+    Vector first_vec(first_set[first_cur], first_set[(first_cur + 1) % first_size]);
+    Vector second_vec(second_set[second_cur], second_set[(second_cur + 1) % second_size]);
+    bool first_moves = second_ptr == second_size || (first_ptr < first_size &&
+        EdgesTurn(first_set[first_cur], first_set[(first_cur + 1) % first_size],
+                  second_set[second_cur], second_set[(second_cur + 1) % second_size]) > 0);
+    Vector edge = first_moves ? first_vec : second_vec;
+    Vector vertex = Vector(first_set[first_cur]) + Vector(second_set[second_cur]); // вершина разности
+    double len = DotProduct(edge, edge);
+    if (len > 0) {
+      double t = std::min(1.0, std::max(0.0, -DotProduct(vertex, edge) / len)); // проекция начала координат на ребро
+      Point first_witness = first_set[first_cur] + (first_moves ? t : 0.0) * first_vec;
+      Point second_witness = Point() + -1.0 * Vector(second_set[second_cur] + (first_moves ? 0.0 : t) * second_vec);
+      double dist = (vertex + t * edge).GetLength();
+      Point corner = Point() + vertex;
+      if (Orient(corner, corner + edge, Point()) < 0) { // начало координат правее ребра, то есть снаружи
+        result.intersect = false;
+      }
+      if (dist < result.distance) {
+        result = Separation{result.intersect, dist, first_witness, second_witness};
+      }
+    }
+    if (first_moves) {
+      ++first_ptr;
+    } else {
+      ++second_ptr;
+    }
+  }
+  return result; // изнутри расстояние до границы и есть глубина проникновения
 }
 
-double Vector::GetPolarAngle() const {
-  double ang = atan2(y, x);
-  if (ang < -EPS) {
-    ang += 2 * M_PI;
+ConvexPolygon::ConvexPolygon(const vector<Point>& set) {
+  int size = set.size();
+  int pivot = min_element(set.begin(), set.end(), ComparePoints<double>) - set.begin();
+  xs.reserve(size);
+  ys.reserve(size);
+  for (int i = 0; i < size; ++i) {
+    xs.push_back(set[(pivot + i) % size].GetX());
+    ys.push_back(set[(pivot + i) % size].GetY());
   }
-  return ang;
 }
 
-Vector& Vector::operator*=(double mod) {
-  x *= mod;
-  y *= mod;
-  return *this;
+bool ConvexPolygon::Contains(const Point& p) const {
+  return Contains(p.GetX(), p.GetY());
+}
+
+bool ConvexPolygon::Contains(double x, double y) const {
+  int size = xs.size();
+  if (size < 3) { // вырожденный многоугольник: точка или отрезок
+    return size > 0 && Orient(xs[0], ys[0], xs[size - 1], ys[size - 1], x, y) == 0 &&
+        std::min(xs[0], xs[size - 1]) <= x && x <= std::max(xs[0], xs[size - 1]) &&
+        std::min(ys[0], ys[size - 1]) <= y && y <= std::max(ys[0], ys[size - 1]);
+  }
+  if (Orient(xs[0], ys[0], xs[1], ys[1], x, y) < 0 || Orient(xs[0], ys[0], xs[size - 1], ys[size - 1], x, y) > 0) { // вне угла при нижней вершине
+    return false;
+  }
+  int left = 1; // последний луч, от которого точка не правее
+  int right = size - 1;
+  while (right - left > 1) {
+    int mid = (left + right) / 2;
+    if (Orient(xs[0], ys[0], xs[mid], ys[mid], x, y) >= 0) {
+      left = mid;
+    } else {
+      right = mid;
+    }
+  }
+  return Orient(xs[left], ys[left], xs[right], ys[right], x, y) >= 0; // не правее ребра треугольника, точка на первом или последнем луче тоже решается здесь
 }
 
-Vector operator*(Vector vec, double mod) {
-  vec *= mod;
-  return vec;
+Vector ConvexPolygon::Vertex(int i) const {
+  return Vector(xs[i], ys[i]);
 }
 
-Vector operator*(double mod, const Vector& vec) {
-  return vec * mod;
+Vector ConvexPolygon::Extreme(const Vector& dir) const {
+  int size = xs.size();
+  Vector border(-dir.GetY(), dir.GetX()); // рёбра до крайней вершины идут под меньшим углом
+  int left = 0;
+  int right = size;
+  while (left < right) { // углы рёбер от нижней вершины возрастают
+    int mid = (left + right) / 2;
+    if (AngleLess(Vertex((mid + 1) % size) - Vertex(mid), border)) {
+      left = mid + 1;
+    } else {
+      right = mid;
+    }
+  }
+  return Vertex(left % size);
 }
 
-Vector& Vector::operator+=(const Vector& other) {
-  x += other.x;
-  y += other.y;
-  return *this;
+bool ConvexPolygon::Intersects(const ConvexPolygon& other, Vector& dir) const {
+  if (dir.GetX() == 0 && dir.GetY() == 0) {
+    dir = Vector(1, 0);
+  }
+  Vector simplex[3];
+  int size = 0;
+  Vector curr = dir;
+  double dist = std::numeric_limits<double>::max(); // от начала координат до симплекса, убывает, пока GJK продвигается
+  while (true) {
+    Vector support = Extreme(curr) - other.Extreme(-1.0 * curr); // опорная точка разности многоугольников
+    double reach = (fabs(support.GetX()) + fabs(support.GetY())) * (fabs(curr.GetX()) + fabs(curr.GetY()));
+    if (Sign(DotProduct(support, curr), reach) < 0) { // начало координат за опорной прямой дальше допуска касания
+      dir = curr;
+      return false;
+    }
+    simplex[size++] = support;
+    if (NearestSimplex(simplex, size, curr)) {
+      return true;
+    }
+    double next_dist = -DotProduct(simplex[0], curr) / curr.GetLength(); // curr - нормаль ближайшей части симплекса
+    if (next_dist >= dist) { // продвижения нет: опорная прямая прошла через симплекс, решает расстояние до него
+      dir = curr;
+      return Sign(next_dist, fabs(simplex[0].GetX()) + fabs(simplex[0].GetY())) == 0;
+    }
+    dist = next_dist;
+  }
 }
 
-Vector operator+(Vector lhs, const Vector& rhs) {
-  lhs += rhs;
-  return lhs;
+vector<uint64_t> ConvexPolygon::ContainsBatch(const vector<double>& qx, const vector<double>& qy) const {
+  int size = qx.size();
+  vector<uint64_t> result((size + 63) / 64);
+  for (int i = 0; i < size; ++i) {
+    if (Contains(qx[i], qy[i])) {
+      result[i / 64] |= uint64_t(1) << (i % 64);
+    }
+  }
+  return result;
 }
 
-Vector& Vector::operator-=(const Vector& other) {
-  x -= other.x;
-  y -= other.y;
-  return *this;
+bool AngleLess(const Vector& lhs, const Vector& rhs) {
+  bool lhs_lower = lhs.GetY() < 0 || (lhs.GetY() == 0 && lhs.GetX() < 0);
+  bool rhs_lower = rhs.GetY() < 0 || (rhs.GetY() == 0 && rhs.GetX() < 0);
+  if (lhs_lower != rhs_lower) {
+    return rhs_lower;
+  }
+  return VectorComp(lhs, rhs) > 0;
 }
 
-Vector operator-(Vector lhs, const Vector& rhs) {
-  lhs -= rhs;
-  return lhs;
+bool NearestSimplex(Vector* simplex, int& size, Vector& dir) {
+  Vector newest = simplex[size - 1];
+  Vector to_origin = -1.0 * newest;
+  Point origin;
+  if (size == 1) {
+    dir = to_origin;
+    return newest.GetX() == 0 && newest.GetY() == 0;
+  }
+  if (size == 2) {
+    Vector edge = simplex[0] - newest;
+    if (DotProduct(edge, to_origin) <= 0) { // ближе всего новая вершина
+      simplex[0] = newest;
+      size = 1;
+      dir = to_origin;
+      return false;
+    }
+    int side = Orient(Point() + newest, Point() + simplex[0], origin);
+    if (side == 0) { // начало координат на отрезке
+      return true;
+    }
+    dir = side > 0 ? Vector(-edge.GetY(), edge.GetX()) : Vector(edge.GetY(), -edge.GetX());
+    return false;
+  }
+  Point last = Point() + newest;
+  Vector first_edge = simplex[1] - newest;
+  Vector second_edge = simplex[0] - newest;
+  int turn = Orient(last, Point() + simplex[1], Point() + simplex[0]);
+  if (turn == 0) { // новая вершина на прямой отрезка, симплекс не меняется
+    size = 2;
+    return false;
+  }
+  if (Orient(last, Point() + simplex[1], origin) == -turn) { // начало координат за ребром с вершиной simplex[1]
+    simplex[0] = simplex[1];
+    simplex[1] = newest;
+    size = 2;
+    dir = turn > 0 ? Vector(first_edge.GetY(), -first_edge.GetX()) : Vector(-first_edge.GetY(), first_edge.GetX());
+    return false;
+  }
+  if (Orient(last, Point() + simplex[0], origin) == turn) { // за ребром с вершиной simplex[0]
+    simplex[1] = newest;
+    size = 2;
+    dir = turn > 0 ? Vector(-second_edge.GetY(), second_edge.GetX()) : Vector(second_edge.GetY(), -second_edge.GetX());
+    return false;
+  }
+  return true; // внутри треугольника или на его границе
 }
 
-istream& operator>>(istream& in, Vector& vec) {
-  in >> vec.x >> vec.y;
-  return in;
+CollisionWorld::CollisionWorld(const vector<vector<Point>>& sets) {
+  int size = sets.size();
+  polygons.reserve(size);
+  boxes.reserve(size);
+  for (int i = 0; i < size; ++i) {
+    polygons.emplace_back(sets[i]);
+    Box box{sets[i][0].GetX(), sets[i][0].GetX(), sets[i][0].GetY(), sets[i][0].GetY(), i};
+    for (const Point& p : sets[i]) {
+      box.min_x = std::min(box.min_x, p.GetX());
+      box.max_x = std::max(box.max_x, p.GetX());
+      box.min_y = std::min(box.min_y, p.GetY());
+      box.max_y = std::max(box.max_y, p.GetY());
+    }
+    boxes.push_back(box);
+  }
+  sort(boxes.begin(), boxes.end(), [](const Box& lhs, const Box& rhs) {
+    return lhs.min_x < rhs.min_x;
+  });
+}
+
+void CollisionWorld::Sweep(int begin, int end, vector<pair<int, int>>& found) const {
+  int size = boxes.size();
+  for (int i = begin; i < end; ++i) {
+    for (int j = i + 1; j < size && boxes[j].min_x <= boxes[i].max_x; ++j) { // пересекаются по x
+      if (boxes[j].min_y > boxes[i].max_y || boxes[i].min_y > boxes[j].max_y) {
+        continue;
+      }
+      int first = std::min(boxes[i].index, boxes[j].index);
+      int second = std::max(boxes[i].index, boxes[j].index);
+      Vector dir(1, 0);
+      if (polygons[first].Intersects(polygons[second], dir)) {
+        found.emplace_back(first, second);
+      }
+    }
+  }
 }
 
-ostream& operator<<(ostream& out, const Vector& vec) {
-  out << vec.x << " " << vec.y;
-  return out;
+vector<pair<int, int>> CollisionWorld::FindPairs(int threads) const {
+  int size = boxes.size();
+  int workers = std::max(1, std::min(threads ? threads : static_cast<int>(std::thread::hardware_concurrency()), size));
+  vector<vector<pair<int, int>>> found(workers);
+  vector<std::thread> pool;
+  for (int w = 0; w < workers; ++w) { // каждый поток обрабатывает свой отрезок боксов
+    pool.emplace_back(&CollisionWorld::Sweep, this, static_cast<long long>(size) * w / workers,
+                      static_cast<long long>(size) * (w + 1) / workers, std::ref(found[w]));
+  }
+  vector<pair<int, int>> result;
+  for (int w = 0; w < workers; ++w) {
+    pool[w].join();
+    result.insert(result.end(), found[w].begin(), found[w].end());
+  }
+  sort(result.begin(), result.end());
+  return result;
 }
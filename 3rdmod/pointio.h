@@ -0,0 +1,162 @@
+#ifndef POINTIO_H_INCLUDED
+#define POINTIO_H_INCLUDED
+
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Быстрый ввод координат: весь вход одним буфером (mmap для файла), текст разбирается from_chars,
+// бинарный формат - те же числа подряд: количества uint32, координаты float64 или float32, little-endian
+
+enum class InputFormat {
+  TEXT,
+  FLOAT64,
+  FLOAT32
+};
+
+inline InputFormat FormatFromArgs(int argc, char** argv) { // --f64 или --f32 среди аргументов
+  InputFormat format = InputFormat::TEXT;
+  for (int i = 1; i < argc; ++i) {
+    if (std::string_view(argv[i]) == "--f64") {
+      format = InputFormat::FLOAT64;
+    } else if (std::string_view(argv[i]) == "--f32") {
+      format = InputFormat::FLOAT32;
+    }
+  }
+  return format;
+}
+
+class InputReader {
+  public:
+    explicit InputReader(InputFormat format, int fd = 0);
+    InputReader(const InputReader& other) = delete;
+    InputReader& operator=(const InputReader& other) = delete;
+    ~InputReader();
+    InputFormat GetFormat() const;
+    std::string_view NextToken(); // Только для текста, пустой в конце входа
+    bool ReadCount(int64_t& count); // false при обрыве или нечисловом токене
+    bool ReadCoords(double* coords, size_t count); // Сразу в непрерывный массив, false при обрыве или нечисловом токене
+  private:
+    uint64_t ReadLittleEndian(int bytes);
+
+    InputFormat format;
+    std::string owned; // Вход из канала, который нельзя отобразить
+    const char* data;
+    size_t size;
+    size_t pos;
+    bool mapped;
+};
+
+inline InputReader::InputReader(InputFormat format, int fd) :
+    format(format),
+    data(nullptr),
+    size(0),
+    pos(0),
+    mapped(false) {
+  struct stat info;
+  if (fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0) {
+    void* addr = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (addr != MAP_FAILED) {
+      madvise(addr, info.st_size, MADV_SEQUENTIAL);
+      data = static_cast<const char*>(addr);
+      size = info.st_size;
+      mapped = true;
+      return;
+    }
+  }
+  char chunk[1 << 16];
+  for (ssize_t got = read(fd, chunk, sizeof(chunk)); got > 0; got = read(fd, chunk, sizeof(chunk))) {
+    owned.append(chunk, got);
+  }
+  data = owned.data();
+  size = owned.size();
+}
+
+inline InputReader::~InputReader() {
+  if (mapped) {
+    munmap(const_cast<char*>(data), size);
+  }
+}
+
+inline InputFormat InputReader::GetFormat() const {
+  return format;
+}
+
+inline std::string_view InputReader::NextToken() {
+  while (pos < size && static_cast<unsigned char>(data[pos]) <= ' ') {
+    ++pos;
+  }
+  size_t begin = pos;
+  while (pos < size && static_cast<unsigned char>(data[pos]) > ' ') {
+    ++pos;
+  }
+  return std::string_view(data + begin, pos - begin);
+}
+
+inline uint64_t InputReader::ReadLittleEndian(int bytes) {
+  uint64_t val = 0;
+  for (int i = 0; i < bytes; ++i) { // Побайтово, чтобы не зависеть от порядка байт машины
+    val |= static_cast<uint64_t>(static_cast<unsigned char>(data[pos + i])) << (8 * i);
+  }
+  pos += bytes;
+  return val;
+}
+
+inline bool InputReader::ReadCount(int64_t& count) {
+  if (format != InputFormat::TEXT) {
+    if (size - pos < 4) {
+      return false;
+    }
+    count = ReadLittleEndian(4);
+    return true;
+  }
+  std::string_view token = NextToken();
+  std::from_chars_result parsed = std::from_chars(token.data(), token.data() + token.size(), count);
+  return parsed.ec == std::errc() && parsed.ptr == token.data() + token.size(); // токен разобран целиком
+}
+
+inline bool InputReader::ReadCoords(double* coords, size_t count) {
+  if (format == InputFormat::FLOAT64) {
+    if ((size - pos) / 8 < count) {
+      return false;
+    }
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    std::memcpy(coords, data + pos, 8 * count); // Порядок байт совпадает, копируется целиком
+    pos += 8 * count;
+#else
+    for (size_t i = 0; i < count; ++i) {
+      uint64_t bits = ReadLittleEndian(8);
+      std::memcpy(coords + i, &bits, sizeof(double));
+    }
+#endif
+    return true;
+  }
+  if (format == InputFormat::FLOAT32) {
+    if ((size - pos) / 4 < count) {
+      return false;
+    }
+    for (size_t i = 0; i < count; ++i) {
+      uint32_t bits = ReadLittleEndian(4);
+      float val;
+      std::memcpy(&val, &bits, sizeof(float));
+      coords[i] = val;
+    }
+    return true;
+  }
+  for (size_t i = 0; i < count; ++i) {
+    std::string_view token = NextToken();
+    const char* begin = token.data() + (!token.empty() && token[0] == '+'); // from_chars не принимает '+'
+    std::from_chars_result parsed = std::from_chars(begin, token.data() + token.size(), coords[i]);
+    if (parsed.ec != std::errc() || parsed.ptr != token.data() + token.size()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+#endif
@@ -0,0 +1,214 @@
+#ifndef PREDICATES_H_INCLUDED
+#define PREDICATES_H_INCLUDED
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+#include <atomic>
+
+// Адаптивные предикаты ориентации по Шевчуку: знак считается в double и проверяется оценкой погрешности,
+// точный пересчёт в разложениях нужен только вблизи нуля
+
+typedef std::vector<double> Expansion; // Неперекрывающиеся слагаемые по возрастанию модуля, сумма точна
+
+static const double HALF_EPS = 1.1102230246251565e-16; // 2^-53
+static const double CROSS_ERR_BOUND = (3 + 16 * HALF_EPS) * HALF_EPS;
+static const double ORIENT3D_ERR_BOUND = (7 + 56 * HALF_EPS) * HALF_EPS;
+
+struct PredicateStats { // Считается только с -DPREDICATE_STATS
+  std::atomic<uint64_t> filtered; // Знак решён фильтром
+  std::atomic<uint64_t> exact; // Понадобился точный пересчёт
+};
+
+inline PredicateStats predicate_stats;
+
+inline void CountPredicate([[maybe_unused]] std::atomic<uint64_t>& counter) {
+#ifdef PREDICATE_STATS
+  counter.fetch_add(1, std::memory_order_relaxed);
+#endif
+}
+
+inline void TwoSum(double a, double b, double& sum, double& err) { // a + b = sum + err точно
+  sum = a + b;
+  double b_virt = sum - a;
+  double a_virt = sum - b_virt;
+  err = (a - a_virt) + (b - b_virt);
+}
+
+inline void TwoProduct(double a, double b, double& prod, double& err) { // a * b = prod + err точно
+  prod = a * b;
+  err = std::fma(a, b, -prod);
+}
+
+inline Expansion ExpansionDiff(double a, double b) {
+  double diff;
+  double err;
+  TwoSum(a, -b, diff, err);
+  return err != 0 ? Expansion{err, diff} : Expansion{diff};
+}
+
+inline Expansion ExpansionGrow(const Expansion& e, double b) { // Прибавление числа, нули выбрасываются
+  Expansion h;
+  double q = b;
+  for (double term : e) {
+    double sum;
+    double err;
+    TwoSum(q, term, sum, err);
+    if (err != 0) {
+      h.push_back(err);
+    }
+    q = sum;
+  }
+  if (q != 0 || h.empty()) {
+    h.push_back(q);
+  }
+  return h;
+}
+
+inline Expansion ExpansionSum(Expansion e, const Expansion& f) {
+  for (double term : f) {
+    e = ExpansionGrow(e, term);
+  }
+  return e;
+}
+
+inline Expansion ExpansionScale(const Expansion& e, double b) {
+  Expansion h;
+  double q;
+  double err;
+  TwoProduct(e[0], b, q, err);
+  if (err != 0) {
+    h.push_back(err);
+  }
+  for (size_t i = 1; i < e.size(); ++i) {
+    double prod;
+    double prod_err;
+    double sum;
+    TwoProduct(e[i], b, prod, prod_err);
+    TwoSum(q, prod_err, sum, err);
+    if (err != 0) {
+      h.push_back(err);
+    }
+    TwoSum(prod, sum, q, err);
+    if (err != 0) {
+      h.push_back(err);
+    }
+  }
+  if (q != 0 || h.empty()) {
+    h.push_back(q);
+  }
+  return h;
+}
+
+inline Expansion ExpansionProduct(const Expansion& e, const Expansion& f) {
+  Expansion h{0};
+  for (double term : f) {
+    h = ExpansionSum(h, ExpansionScale(e, term));
+  }
+  return h;
+}
+
+inline Expansion ExpansionNegate(Expansion e) {
+  for (double& term : e) {
+    term = -term;
+  }
+  return e;
+}
+
+inline int ExpansionSign(const Expansion& e) { // Знак старшего слагаемого
+  return (e.back() > 0) - (e.back() < 0);
+}
+
+__attribute__((noinline)) inline int CrossSignExact(double ax, double ay, double bx, double by,
+                          double cx, double cy, double dx, double dy) {
+  Expansion exact_left = ExpansionProduct(ExpansionDiff(bx, ax), ExpansionDiff(dy, cy));
+  Expansion exact_right = ExpansionProduct(ExpansionDiff(by, ay), ExpansionDiff(dx, cx));
+  return ExpansionSign(ExpansionSum(exact_left, ExpansionNegate(exact_right)));
+}
+
+__attribute__((noinline)) inline int Orient3dExact(const double (&a)[3], const double (&b)[3], const double (&c)[3], const double (&d)[3]) {
+  Expansion u[3];
+  Expansion v[3];
+  Expansion w[3];
+  for (int i = 0; i < 3; ++i) {
+    u[i] = ExpansionDiff(b[i], a[i]);
+    v[i] = ExpansionDiff(c[i], a[i]);
+    w[i] = ExpansionDiff(d[i], a[i]);
+  }
+  Expansion result{0};
+  for (int i = 0; i < 3; ++i) { // Разложение по первой строке
+    Expansion minor = ExpansionSum(ExpansionProduct(v[(i + 1) % 3], w[(i + 2) % 3]), ExpansionNegate(ExpansionProduct(v[(i + 2) % 3], w[(i + 1) % 3])));
+    result = ExpansionSum(result, ExpansionProduct(u[i], minor));
+  }
+  return ExpansionSign(result);
+}
+
+inline int CrossSign(double ax, double ay, double bx, double by,
+                     double cx, double cy, double dx, double dy) { // Знак (b - a) x (d - c)
+  double left = (bx - ax) * (dy - cy);
+  double right = (by - ay) * (dx - cx);
+  double det = left - right;
+  double err_bound = CROSS_ERR_BOUND * (fabs(left) + fabs(right));
+  if (fabs(det) > err_bound) { // Одна предсказуемая ветка вместо двух по знаку
+    CountPredicate(predicate_stats.filtered);
+    return (det > 0) - (det < 0);
+  }
+  CountPredicate(predicate_stats.exact);
+  return CrossSignExact(ax, ay, bx, by, cx, cy, dx, dy);
+}
+
+inline int Orient2d(double ax, double ay, double bx, double by, double cx, double cy) { // 1, если a, b, c против часовой
+  return CrossSign(ax, ay, bx, by, ax, ay, cx, cy);
+}
+
+inline int Orient3d(double ax, double ay, double az, double bx, double by, double bz,
+                    double cx, double cy, double cz, double dx, double dy, double dz) { // Знак (b - a) x (c - a) * (d - a)
+  double ux = bx - ax;
+  double uy = by - ay;
+  double uz = bz - az;
+  double vx = cx - ax;
+  double vy = cy - ay;
+  double vz = cz - az;
+  double wx = dx - ax;
+  double wy = dy - ay;
+  double wz = dz - az;
+  double vywz = vy * wz;
+  double vzwy = vz * wy;
+  double vzwx = vz * wx;
+  double vxwz = vx * wz;
+  double vxwy = vx * wy;
+  double vywx = vy * wx;
+  double det = ux * (vywz - vzwy) + uy * (vzwx - vxwz) + uz * (vxwy - vywx);
+  double permanent = (fabs(vywz) + fabs(vzwy)) * fabs(ux) +
+                     (fabs(vzwx) + fabs(vxwz)) * fabs(uy) +
+                     (fabs(vxwy) + fabs(vywx)) * fabs(uz);
+  double err_bound = ORIENT3D_ERR_BOUND * permanent;
+  if (fabs(det) > err_bound) { // Одна предсказуемая ветка вместо двух по знаку
+    CountPredicate(predicate_stats.filtered);
+    return (det > 0) - (det < 0);
+  }
+  CountPredicate(predicate_stats.exact);
+  double a[3] = {ax, ay, az};
+  double b[3] = {bx, by, bz};
+  double c[3] = {cx, cy, cz};
+  double d[3] = {dx, dy, dz};
+  return Orient3dExact(a, b, c, d);
+}
+
+template <typename Point>
+int CrossSign(const Point& a, const Point& b, const Point& c, const Point& d) {
+  return CrossSign(a.GetX(), a.GetY(), b.GetX(), b.GetY(), c.GetX(), c.GetY(), d.GetX(), d.GetY());
+}
+
+template <typename Point>
+int Orient2d(const Point& a, const Point& b, const Point& c) {
+  return Orient2d(a.GetX(), a.GetY(), b.GetX(), b.GetY(), c.GetX(), c.GetY());
+}
+
+template <typename Point>
+int Orient3d(const Point& a, const Point& b, const Point& c, const Point& d) {
+  return Orient3d(a.GetX(), a.GetY(), a.GetZ(), b.GetX(), b.GetY(), b.GetZ(),
+                  c.GetX(), c.GetY(), c.GetZ(), d.GetX(), d.GetY(), d.GetZ());
+}
+
+#endif